@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace letter {
+
+/**
+ * @brief: bump allocator, everything allocated from it is freed in one shot
+ * Objects are never destructed, so only trivially destructible types may live here.
+ * `reset` rewinds to the first block and keeps every block for reuse.
+ */
+class Arena {
+private:
+  struct Block {
+    std::unique_ptr<char[]> data;
+    std::size_t size;
+  };
+
+  std::vector<Block> m_blocks;
+  std::size_t m_block_index;  // block currently bumped
+  char* m_cursor;
+  char* m_end;
+  std::size_t m_block_size;
+  std::size_t m_bytes_used;   // bytes handed out since last reset, padding included
+
+public:
+  explicit Arena(std::size_t block_size = 64 * 1024)
+    : m_block_index(0), m_cursor(nullptr), m_end(nullptr),
+      m_block_size(block_size), m_bytes_used(0) {}
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /**
+   * @brief: take over the blocks of `other`, which is left empty
+   * what was allocated from `other` stays where it is, and now belongs to this arena
+   */
+  Arena(Arena&& other) noexcept
+    : m_blocks(std::move(other.m_blocks)), m_block_index(other.m_block_index), 
+      m_cursor(other.m_cursor), m_end(other.m_end),
+      m_block_size(other.m_block_size), m_bytes_used(other.m_bytes_used) {
+    other._forget();
+  }
+
+  Arena& operator=(Arena&& other) noexcept {
+    if (this != &other) {
+      this->m_blocks = std::move(other.m_blocks);
+      this->m_block_index = other.m_block_index;
+      this->m_cursor = other.m_cursor;
+      this->m_end = other.m_end;
+      this->m_block_size = other.m_block_size;
+      this->m_bytes_used = other.m_bytes_used;
+      other._forget();
+    }
+    return *this;
+  }
+
+  inline void* allocate(std::size_t size, std::size_t align = alignof(std::max_align_t)) {
+    char* p = _align(this->m_cursor, align);
+    if (!this->m_cursor || p + size > this->m_end) {
+      p = this->_grow(size, align);
+    }
+    this->m_bytes_used += (p + size) - this->m_cursor;
+    this->m_cursor = p + size;
+    return p;
+  }
+
+  template <typename T, typename... Args>
+  inline T* make(Args&&... args) {
+    static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destructed");
+    return new (this->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief: uninitialized storage of `count` T
+   */
+  template <typename T>
+  inline T* allocateArray(std::size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destructed");
+    if (count == 0) {
+      return nullptr;
+    }
+    return static_cast<T*>(this->allocate(sizeof(T) * count, alignof(T)));
+  }
+
+  /**
+   * @brief: drop everything allocated, keep the blocks for reuse
+   */
+  void reset() {
+    this->m_block_index = 0;
+    this->m_bytes_used = 0;
+    if (this->m_blocks.empty()) {
+      this->m_cursor = this->m_end = nullptr;
+    } else {
+      this->m_cursor = this->m_blocks[0].data.get();
+      this->m_end = this->m_cursor + this->m_blocks[0].size;
+    }
+  }
+
+  /**
+   * @brief: take over the blocks of `other`, which is left empty, and keep allocating where this arena was
+   * what was allocated from either arena now belongs to this one, until the next `reset`
+   */
+  void adopt(Arena&& other) {
+    if (this == &other || other.m_blocks.empty()) {
+      return;
+    }
+    // in front of the block being bumped, which `_grow` never goes back to
+    const std::size_t count = other.m_blocks.size();
+    this->m_blocks.insert(this->m_blocks.begin(), std::make_move_iterator(other.m_blocks.begin()),
+      std::make_move_iterator(other.m_blocks.end()));
+    if (this->m_cursor) {
+      this->m_block_index += count;
+    }
+    this->m_bytes_used += other.m_bytes_used;
+    other._forget();
+  }
+
+  inline std::size_t bytesUsed() const { return this->m_bytes_used; }
+
+  std::size_t bytesReserved() const {
+    std::size_t total = 0;
+    for (auto&& block : this->m_blocks) {
+      total += block.size;
+    }
+    return total;
+  }
+
+private:
+  inline void _forget() {
+    this->m_blocks.clear();
+    this->m_block_index = 0;
+    this->m_cursor = this->m_end = nullptr;
+    this->m_bytes_used = 0;
+  }
+
+  static inline char* _align(char* p, std::size_t align) {
+    auto v = reinterpret_cast<std::uintptr_t>(p);
+    return reinterpret_cast<char*>((v + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1));
+  }
+
+  /**
+   * @brief: move on to the next block which can hold `size` bytes, allocate one if needed
+   */
+  char* _grow(std::size_t size, std::size_t align) {
+    const std::size_t needed = size + align;
+
+    // reuse the blocks kept by `reset`
+    while (this->m_cursor && this->m_block_index + 1 < this->m_blocks.size()) {
+      auto& block = this->m_blocks[++this->m_block_index];
+      if (block.size >= needed) {
+        this->m_cursor = block.data.get();
+        this->m_end = this->m_cursor + block.size;
+        return _align(this->m_cursor, align);
+      }
+    }
+
+    std::size_t block_size = needed > this->m_block_size ? needed : this->m_block_size;
+    this->m_blocks.push_back(Block{std::unique_ptr<char[]>(new char[block_size]), block_size});
+    this->m_block_index = this->m_blocks.size() - 1;
+
+    auto& block = this->m_blocks[this->m_block_index];
+    this->m_cursor = block.data.get();
+    this->m_end = this->m_cursor + block.size;
+    return _align(this->m_cursor, align);
+  }
+};
+
+} // namespace letter
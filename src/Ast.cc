@@ -0,0 +1,180 @@
+#include "Ast.h"
+#include "Exception.h"
+#include "Instrument.h"
+#include "Profiler.h"
+
+#include <string>
+
+namespace letter {
+namespace ast {
+
+const char* nodeTypeName(NodeType type) {
+  switch (type) {
+  case NodeType::Program:              return "Program";
+  case NodeType::ExpressionStatement:  return "ExpressionStatement";
+  case NodeType::BlockStatement:       return "BlockStatement";
+  case NodeType::EmptyStatement:       return "EmptyStatement";
+  case NodeType::AssignmentExpression: return "AssignmentExpression";
+  case NodeType::BinaryExpression:     return "BinaryExpression";
+  case NodeType::Identifier:           return "Identifier";
+  case NodeType::NumericLiteral:       return "NumericLiteral";
+  case NodeType::StringLiteral:        return "StringLiteral";
+  }
+  return "Unknown";
+}
+
+const char* operatorText(Operator op) {
+  switch (op) {
+  case Operator::Add:       return "+";
+  case Operator::Sub:       return "-";
+  case Operator::Mul:       return "*";
+  case Operator::Div:       return "/";
+  case Operator::Assign:    return "=";
+  case Operator::AddAssign: return "+=";
+  case Operator::SubAssign: return "-=";
+  case Operator::MulAssign: return "*=";
+  case Operator::DivAssign: return "/=";
+  }
+  return "?";
+}
+
+Operator operatorFromText(std::string_view text) {
+  const bool assign = text.size() == 2 && text[1] == '=';
+  switch (text.empty() ? '\0' : text[0]) {
+  case '+': return assign ? Operator::AddAssign : Operator::Add;
+  case '-': return assign ? Operator::SubAssign : Operator::Sub;
+  case '*': return assign ? Operator::MulAssign : Operator::Mul;
+  case '/': return assign ? Operator::DivAssign : Operator::Div;
+  case '=': return Operator::Assign;
+  }
+  throw Exception("Unknown operator: " + std::string(text));
+}
+
+static std::size_t _countList(const NodeList<Statement>& list) {
+  std::size_t count = 0;
+  for (auto* statement : list) {
+    count += countNodes(*statement);
+  }
+  return count;
+}
+
+std::size_t countNodes(const Node& node) {
+  switch (node.type) {
+  case NodeType::Program:
+    return 1 + _countList(static_cast<const Program&>(node).body);
+  case NodeType::BlockStatement:
+    return 1 + _countList(static_cast<const BlockStatement&>(node).statements());
+  case NodeType::ExpressionStatement:
+    return 1 + countNodes(*static_cast<const ExpressionStatement&>(node).expression);
+  case NodeType::AssignmentExpression: {
+    auto&& e = static_cast<const AssignmentExpression&>(node);
+    return 1 + countNodes(*e.left) + countNodes(*e.right);
+  }
+  case NodeType::BinaryExpression: {
+    auto&& e = static_cast<const BinaryExpression&>(node);
+    return 1 + countNodes(*e.left) + countNodes(*e.right);
+  }
+  default:
+    return 1;
+  }
+}
+
+static json::value _listToJson(const NodeList<Statement>& list, const SymbolTable& symbols, const LineIndex* lines) {
+  json::array array;
+  for (auto* statement : list) {
+    array.emplace_back(toJson(*statement, symbols, lines));
+  }
+  return array;
+}
+
+static json::value _positionToJson(SourcePosition position) {
+  return json::object{
+    {"line", position.line},
+    {"column", position.column}
+  };
+}
+
+static json::object _nodeToJson(const Node& node, const SymbolTable& symbols, const LineIndex* lines) {
+  switch (node.type) {
+  case NodeType::Program:
+    return json::object{
+      {"type", "Program"},
+      {"body", _listToJson(static_cast<const Program&>(node).body, symbols, lines)}
+    };
+
+  case NodeType::ExpressionStatement:
+    return json::object{
+      {"type", "ExpressionStatement"},
+      {"expression", toJson(*static_cast<const ExpressionStatement&>(node).expression, symbols, lines)}
+    };
+
+  case NodeType::BlockStatement:
+    return json::object{
+      {"type", "BlockStatement"},
+      {"body", _listToJson(static_cast<const BlockStatement&>(node).statements(), symbols, lines)}
+    };
+
+  case NodeType::EmptyStatement:
+    return json::object{
+      {"type", "EmptyStatement"}
+    };
+
+  case NodeType::AssignmentExpression: {
+    auto&& e = static_cast<const AssignmentExpression&>(node);
+    return json::object{
+      {"type", "AssignmentExpression"},
+      {"operator", operatorText(e.op)},
+      {"left", toJson(*e.left, symbols, lines)},
+      {"right", toJson(*e.right, symbols, lines)}
+    };
+  }
+
+  case NodeType::BinaryExpression: {
+    auto&& e = static_cast<const BinaryExpression&>(node);
+    return json::object{
+      {"type", "BinaryExpression"},
+      {"operator", operatorText(e.op)},
+      {"left", toJson(*e.left, symbols, lines)},
+      {"right", toJson(*e.right, symbols, lines)}
+    };
+  }
+
+  case NodeType::Identifier:
+    return json::object{
+      {"type", "Identifier"},
+      {"name", std::string(symbols.name(static_cast<const Identifier&>(node).name))}
+    };
+
+  case NodeType::NumericLiteral: {
+    auto&& value = static_cast<const NumericLiteral&>(node).value;
+    return json::object{
+      {"type", "NumericLiteral"},
+      {"value", value.isReal() ? json::value(value.real) : json::value(static_cast<long long>(value.integer))}
+    };
+  }
+
+  case NodeType::StringLiteral:
+    return json::object{
+      {"type", "StringLiteral"},
+      {"value", std::string(symbols.name(static_cast<const StringLiteral&>(node).value))}
+    };
+  }
+
+  throw Exception("Unknown node type");
+}
+
+json::value toJson(const Node& node, const SymbolTable& symbols, const LineIndex* lines/*= nullptr*/) {
+  instrument::PhaseScope phase(instrument::Phase::Serialize);
+  LETTER_PROFILE_ZONE("ast::toJson");
+  auto&& object = _nodeToJson(node, symbols, lines);
+  if (lines) {
+    object["loc"] = json::object{
+      {"start", _positionToJson(lines->position(node.span.offset))},
+      {"end", _positionToJson(lines->position(node.span.end()))}
+    };
+  }
+  return object;
+}
+
+} // namespace ast
+} // namespace letter
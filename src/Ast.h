@@ -0,0 +1,235 @@
+#pragma once
+
+#include "json.hpp"
+#include "Exception.h"
+#include "Number.h"
+#include "SourceLocation.h"
+#include "SymbolTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace letter {
+namespace ast {
+
+/**
+ * @brief: type of a node, the comment is its "type" in the json form
+ */
+enum class NodeType : uint8_t {
+  Program,                  // "Program"
+  ExpressionStatement,      // "ExpressionStatement"
+  BlockStatement,           // "BlockStatement"
+  EmptyStatement,           // "EmptyStatement"
+  AssignmentExpression,     // "AssignmentExpression"
+  BinaryExpression,         // "BinaryExpression"
+  Identifier,               // "Identifier"
+  NumericLiteral,           // "NumericLiteral"
+  StringLiteral,            // "StringLiteral"
+};
+
+/**
+ * @brief: operators of BinaryExpression and AssignmentExpression
+ */
+enum class Operator : uint8_t {
+  Add,          // +
+  Sub,          // -
+  Mul,          // *
+  Div,          // /
+  Assign,       // =
+  AddAssign,    // +=
+  SubAssign,    // -=
+  MulAssign,    // *=
+  DivAssign,    // /=
+};
+
+const char* nodeTypeName(NodeType type);
+
+const char* operatorText(Operator op);
+
+/**
+ * @brief: the operator spelled by `text`, e.g. "+=" -> Operator::AddAssign
+ */
+Operator operatorFromText(std::string_view text);
+
+/**
+ * Nodes are allocated from the `Arena` of a parse and never destructed,
+ * so they only hold trivially destructible members: child pointers,
+ * arena arrays and atoms of the parse's `SymbolTable`.
+ * `span` is left empty unless the parser locates nodes, see `Parser::setLocations`.
+ */
+struct Node {
+  NodeType type;
+  SourceSpan span;
+
+  explicit Node(NodeType t) : type(t), span() {}
+};
+
+struct Statement : Node {
+  using Node::Node;
+};
+
+struct Expression : Node {
+  using Node::Node;
+};
+
+/**
+ * @brief: array of child nodes allocated from the arena
+ */
+template <typename T>
+struct NodeList {
+  T** data = nullptr;
+  uint32_t size = 0;
+
+  inline T** begin() const { return this->data; }
+  inline T** end() const { return this->data + this->size; }
+  inline bool empty() const { return this->size == 0; }
+  inline T* operator[](std::size_t i) const { return this->data[i]; }
+};
+
+struct Program : Node {
+  static constexpr NodeType kType = NodeType::Program;
+  NodeList<Statement> body;
+
+  explicit Program(NodeList<Statement> b) : Node(kType), body(b) {}
+};
+
+struct ExpressionStatement : Statement {
+  static constexpr NodeType kType = NodeType::ExpressionStatement;
+  Expression* expression;
+
+  explicit ExpressionStatement(Expression* e) : Statement(kType), expression(e) {}
+};
+
+struct BlockStatement;
+
+/**
+ * @brief: parses the body of a lazy BlockStatement, see `Parser::setLazyBlocks`
+ */
+class BodyParser {
+public:
+  virtual void parseBody(BlockStatement& block) = 0;
+
+protected:
+  ~BodyParser() = default;
+};
+
+/**
+ * @brief: a block body not parsed yet: its parser, the bytes between the braces, and the
+ * settings of the parse which skipped it, the body is parsed with them
+ * The parser keeps the source and the arena of the body: a tree with lazy bodies must not
+ * outlive its parser, nor its next parse. `Parser::release` parses them all first.
+ */
+struct LazyBody {
+  BodyParser* parser;
+  uint32_t offset;
+  uint32_t length;
+  bool locations;
+};
+
+struct BlockStatement : Statement {
+  static constexpr NodeType kType = NodeType::BlockStatement;
+  NodeList<Statement> body;   // empty while `lazy`, read it through `statements`
+  LazyBody* lazy;             // nullptr once the body is parsed
+
+  explicit BlockStatement(NodeList<Statement> b, LazyBody* l = nullptr) : Statement(kType), body(b), lazy(l) {}
+
+  /**
+   * @brief: the body, parsed first if the block is lazy
+   * throw `letter::Exception` on a syntax error in it, the block stays lazy.
+   * Not thread-safe while the block is lazy.
+   */
+  inline NodeList<Statement>& statements() {
+    if (this->lazy) {
+      this->lazy->parser->parseBody(*this);
+    }
+    return this->body;
+  }
+
+  /**
+   * @brief: the body of a block already parsed, a read only tree is never parsed further
+   * throw `letter::Exception` if the block is still lazy: parse it first, through the non-const
+   * `statements` or `Parser::validate`
+   */
+  inline const NodeList<Statement>& statements() const {
+    if (this->lazy) {
+      throw Exception("Lazy block body not parsed yet, see Parser::validate");
+    }
+    return this->body;
+  }
+};
+
+struct EmptyStatement : Statement {
+  static constexpr NodeType kType = NodeType::EmptyStatement;
+
+  EmptyStatement() : Statement(kType) {}
+};
+
+struct AssignmentExpression : Expression {
+  static constexpr NodeType kType = NodeType::AssignmentExpression;
+  Operator op;
+  Expression* left;
+  Expression* right;
+
+  AssignmentExpression(Operator o, Expression* l, Expression* r)
+    : Expression(kType), op(o), left(l), right(r) {}
+};
+
+struct BinaryExpression : Expression {
+  static constexpr NodeType kType = NodeType::BinaryExpression;
+  Operator op;
+  Expression* left;
+  Expression* right;
+
+  BinaryExpression(Operator o, Expression* l, Expression* r)
+    : Expression(kType), op(o), left(l), right(r) {}
+};
+
+constexpr uint32_t kNoSlot = UINT32_MAX;
+
+struct Identifier : Expression {
+  static constexpr NodeType kType = NodeType::Identifier;
+  Atom name;
+  uint32_t slot; // variable slot, filled by `resolveSlots`, kNoSlot until then
+
+  explicit Identifier(Atom n) : Expression(kType), name(n), slot(kNoSlot) {}
+};
+
+struct NumericLiteral : Expression {
+  static constexpr NodeType kType = NodeType::NumericLiteral;
+  NumberValue value; // an int64_t or a double, never `OutOfRange`
+
+  explicit NumericLiteral(NumberValue v) : Expression(kType), value(v) {}
+};
+
+struct StringLiteral : Expression {
+  static constexpr NodeType kType = NodeType::StringLiteral;
+  Atom value; // contents, without the quotes
+
+  explicit StringLiteral(Atom v) : Expression(kType), value(v) {}
+};
+
+/**
+ * @brief: downcast, nullptr if `node` is not a T
+ */
+template <typename T, typename N>
+inline T* cast(N* node) {
+  return node && node->type == T::kType ? static_cast<T*>(node) : nullptr;
+}
+
+/**
+ * @brief: number of nodes in the subtree rooted at `node`, `node` included
+ */
+std::size_t countNodes(const Node& node);
+
+/**
+ * @brief: serialize to the json shape of the AST, e.g.
+ * {"type": "BinaryExpression", "operator": "+", "left": {...}, "right": {...}}
+ * With the `lines` of the source, every node also gets the line and column of its span:
+ * "loc": {"start": {"line": 1, "column": 0}, "end": {"line": 1, "column": 5}}
+ * `JsonWriter::writeAst` streams the same text without building the json value.
+ */
+json::value toJson(const Node& node, const SymbolTable& symbols, const LineIndex* lines = nullptr);
+
+} // namespace ast
+} // namespace letter
@@ -0,0 +1,297 @@
+#include "BinaryAst.h"
+#include "Exception.h"
+
+#include <cstring>
+#include <vector>
+
+namespace letter {
+
+static constexpr char s_magic[4] = {'L', 'T', 'R', 'A'};
+
+uint64_t hashSource(std::string_view source) {
+  // 8 bytes a step, multiply and rotate, with the final mix of MurmurHash3
+  const uint64_t k = 0x9E3779B97F4A7C15ull;
+  uint64_t hash = source.size() * k;
+  std::size_t i = 0;
+  for (; i + 8 <= source.size(); i += 8) {
+    uint64_t word;
+    std::memcpy(&word, source.data() + i, 8);
+    hash = ((hash ^ word) * k);
+    hash = (hash << 31) | (hash >> 33);
+  }
+  for (; i < source.size(); ++i) {
+    hash = (hash ^ static_cast<unsigned char>(source[i])) * k;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDull;
+  hash ^= hash >> 33;
+  hash *= 0xC4CEB9FE1A85EC53ull;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+/**
+ * @brief: appends the nodes in postorder, the index of a node is known once its children are in
+ */
+struct _Encoder {
+  std::vector<BinaryNode> nodes;
+  std::vector<uint64_t> numbers;
+  std::vector<uint32_t> lists;
+  std::vector<uint32_t> scratch;  // statements of the lists being encoded, nested ones on top
+
+  uint32_t add(ast::NodeType type, ast::Operator op, uint32_t a, uint16_t flags = 0) {
+    this->nodes.push_back(BinaryNode{type, op, flags, a});
+    return static_cast<uint32_t>(this->nodes.size() - 1);
+  }
+
+  uint32_t list(ast::NodeType type, const ast::NodeList<ast::Statement>& body) {
+    const std::size_t base = this->scratch.size();
+    for (auto* statement : body) {
+      const uint32_t index = this->encode(*statement);
+      this->scratch.push_back(index);
+    }
+    const auto offset = static_cast<uint32_t>(this->lists.size());
+    this->lists.push_back(body.size);
+    this->lists.insert(this->lists.end(), this->scratch.begin() + base, this->scratch.end());
+    this->scratch.resize(base);
+    return this->add(type, ast::Operator::Add, offset);
+  }
+
+  uint32_t encode(const ast::Node& node) {
+    switch (node.type) {
+    case ast::NodeType::Program:
+      return this->list(node.type, static_cast<const ast::Program&>(node).body);
+    case ast::NodeType::BlockStatement:
+      return this->list(node.type, static_cast<const ast::BlockStatement&>(node).statements());
+    case ast::NodeType::ExpressionStatement:
+      this->encode(*static_cast<const ast::ExpressionStatement&>(node).expression);
+      return this->add(node.type, ast::Operator::Add, 0);
+    case ast::NodeType::AssignmentExpression: {
+      auto&& e = static_cast<const ast::AssignmentExpression&>(node);
+      const uint32_t left = this->encode(*e.left);
+      this->encode(*e.right);
+      return this->add(node.type, e.op, left);
+    }
+    case ast::NodeType::BinaryExpression: {
+      auto&& e = static_cast<const ast::BinaryExpression&>(node);
+      const uint32_t left = this->encode(*e.left);
+      this->encode(*e.right);
+      return this->add(node.type, e.op, left);
+    }
+    case ast::NodeType::Identifier:
+      return this->add(node.type, ast::Operator::Add, static_cast<const ast::Identifier&>(node).name);
+    case ast::NodeType::NumericLiteral: {
+      auto&& value = static_cast<const ast::NumericLiteral&>(node).value;
+      uint64_t bits;
+      if (value.isReal()) {
+        std::memcpy(&bits, &value.real, sizeof(bits));
+      } else {
+        std::memcpy(&bits, &value.integer, sizeof(bits));
+      }
+      this->numbers.push_back(bits);
+      return this->add(node.type, ast::Operator::Add, static_cast<uint32_t>(this->numbers.size() - 1), value.isReal());
+    }
+    case ast::NodeType::StringLiteral:
+      return this->add(node.type, ast::Operator::Add, static_cast<const ast::StringLiteral&>(node).value);
+    case ast::NodeType::EmptyStatement:
+      return this->add(node.type, ast::Operator::Add, 0);
+    }
+    throw Exception("Unknown node type");
+  }
+};
+
+template <typename T>
+static void _append(std::string& out, const T* data, std::size_t count) {
+  out.append(reinterpret_cast<const char*>(data), sizeof(T) * count);
+}
+
+std::string encodeBinaryAst(const ast::Program& program, const SymbolTable& symbols, 
+    uint64_t source_hash, uint64_t source_size) {
+  _Encoder encoder;
+  encoder.encode(program);
+
+  std::vector<uint32_t> atoms;
+  atoms.reserve(symbols.size() + 1);
+  uint32_t chars = 0;
+  for (Atom atom = 0; atom < symbols.size(); ++atom) {
+    atoms.push_back(chars);
+    chars += static_cast<uint32_t>(symbols.name(atom).size());
+  }
+  atoms.push_back(chars);
+
+  BinaryAstHeader header{};
+  std::memcpy(header.magic, s_magic, sizeof(s_magic));
+  header.version = kBinaryAstVersion;
+  header.source_hash = source_hash;
+  header.source_size = source_size;
+  header.node_count = static_cast<uint32_t>(encoder.nodes.size());
+  header.list_count = static_cast<uint32_t>(encoder.lists.size());
+  header.atom_count = static_cast<uint32_t>(symbols.size());
+  header.char_count = chars;
+  header.number_count = static_cast<uint32_t>(encoder.numbers.size());
+
+  std::string out;
+  out.reserve(sizeof(header) + sizeof(BinaryNode) * encoder.nodes.size() + sizeof(uint64_t) * encoder.numbers.size() +
+      sizeof(uint32_t) * (encoder.lists.size() + atoms.size()) + chars);
+  _append(out, &header, 1);
+  _append(out, encoder.nodes.data(), encoder.nodes.size());
+  _append(out, encoder.numbers.data(), encoder.numbers.size());
+  _append(out, encoder.lists.data(), encoder.lists.size());
+  _append(out, atoms.data(), atoms.size());
+  for (Atom atom = 0; atom < symbols.size(); ++atom) {
+    out += symbols.name(atom);
+  }
+  return out;
+}
+
+static Exception _malformed(const std::string& what) {
+  return Exception("Malformed binary ast: " + what);
+}
+
+BinaryAstView::BinaryAstView(std::string_view bytes) : m_bytes(bytes) {
+  if (bytes.size() < sizeof(BinaryAstHeader) || std::memcmp(bytes.data(), s_magic, sizeof(s_magic)) != 0) {
+    throw _malformed("no header");
+  }
+  // the sections are 8 byte aligned up to `numbers`, as a mapping is
+  if (reinterpret_cast<std::uintptr_t>(bytes.data()) % alignof(BinaryAstHeader) != 0) {
+    throw _malformed("misaligned");
+  }
+  this->m_header = reinterpret_cast<const BinaryAstHeader*>(bytes.data());
+
+  auto&& h = *this->m_header;
+  if (h.version != kBinaryAstVersion) {
+    throw _malformed("version " + std::to_string(h.version) + ", expected " + std::to_string(kBinaryAstVersion));
+  }
+  const uint64_t size = sizeof(BinaryAstHeader) + uint64_t(sizeof(BinaryNode)) * h.node_count + 
+    uint64_t(sizeof(uint64_t)) * h.number_count +
+    uint64_t(sizeof(uint32_t)) * (uint64_t(h.list_count) + h.atom_count + 1) + h.char_count;
+  if (size != bytes.size() || h.node_count == 0) {
+    throw _malformed("size " + std::to_string(bytes.size()) + ", expected " + std::to_string(size));
+  }
+
+  this->m_nodes = reinterpret_cast<const BinaryNode*>(bytes.data() + sizeof(BinaryAstHeader));
+  this->m_numbers = reinterpret_cast<const uint64_t*>(this->m_nodes + h.node_count);
+  this->m_lists = reinterpret_cast<const uint32_t*>(this->m_numbers + h.number_count);
+  this->m_atoms = this->m_lists + h.list_count;
+  this->m_chars = reinterpret_cast<const char*>(this->m_atoms + h.atom_count + 1);
+
+  for (uint32_t atom = 0; atom < h.atom_count; ++atom) {
+    if (this->m_atoms[atom] > this->m_atoms[atom + 1]) {
+      throw _malformed("atom " + std::to_string(atom));
+    }
+  }
+  if (this->m_atoms[0] != 0 || this->m_atoms[h.atom_count] != h.char_count) {
+    throw _malformed("atoms");
+  }
+}
+
+ast::Program* BinaryAstView::decode(Arena& arena, SymbolTable& symbols) const {
+  auto&& h = *this->m_header;
+
+  symbols.clear();
+  std::vector<Atom> atoms(h.atom_count);
+  for (uint32_t atom = 0; atom < h.atom_count; ++atom) {
+    atoms[atom] = symbols.intern(this->atom(atom));
+  }
+
+  // postorder: every child is decoded before its parent
+  std::vector<ast::Node*> nodes(h.node_count);
+  auto&& child = [&](uint32_t index, uint32_t parent) -> ast::Node* {
+    if (index >= parent) {
+      throw _malformed("node " + std::to_string(parent));
+    }
+    return nodes[index];
+  };
+  auto&& expression = [&](uint32_t index, uint32_t parent) {
+    auto* node = child(index, parent);
+    if (node->type < ast::NodeType::AssignmentExpression) {
+      throw _malformed("node " + std::to_string(parent));
+    }
+    return static_cast<ast::Expression*>(node);
+  };
+  auto&& atom = [&](uint32_t atom, uint32_t parent) {
+    if (atom >= h.atom_count) {
+      throw _malformed("node " + std::to_string(parent));
+    }
+    return atoms[atom];
+  };
+  auto&& list = [&](const BinaryNode& node, uint32_t parent) {
+    if (node.a >= h.list_count || this->m_lists[node.a] > h.list_count - node.a - 1) {
+      throw _malformed("node " + std::to_string(parent));
+    }
+    const uint32_t* entries = this->m_lists + node.a + 1;
+    ast::NodeList<ast::Statement> body;
+    body.size = this->m_lists[node.a];
+    body.data = arena.allocateArray<ast::Statement*>(body.size);
+    for (uint32_t i = 0; i < body.size; ++i) {
+      auto* statement = child(entries[i], parent);
+      if (statement->type == ast::NodeType::Program || statement->type >= ast::NodeType::AssignmentExpression) {
+        throw _malformed("node " + std::to_string(parent));
+      }
+      body.data[i] = static_cast<ast::Statement*>(statement);
+    }
+    return body;
+  };
+
+  for (uint32_t i = 0; i < h.node_count; ++i) {
+    auto&& node = this->m_nodes[i];
+    switch (node.type) {
+    case ast::NodeType::Program:
+      nodes[i] = arena.make<ast::Program>(list(node, i));
+      break;
+    case ast::NodeType::BlockStatement:
+      nodes[i] = arena.make<ast::BlockStatement>(list(node, i));
+      break;
+    case ast::NodeType::ExpressionStatement:
+      nodes[i] = arena.make<ast::ExpressionStatement>(expression(i - 1, i));
+      break;
+    case ast::NodeType::EmptyStatement:
+      nodes[i] = arena.make<ast::EmptyStatement>();
+      break;
+    case ast::NodeType::AssignmentExpression:
+      if (node.op < ast::Operator::Assign || node.op > ast::Operator::DivAssign || 
+          expression(node.a, i)->type != ast::NodeType::Identifier) {
+        throw _malformed("node " + std::to_string(i));
+      }
+      nodes[i] = arena.make<ast::AssignmentExpression>(node.op, expression(node.a, i), expression(i - 1, i));
+      break;
+    case ast::NodeType::BinaryExpression:
+      if (node.op > ast::Operator::Div) {
+        throw _malformed("node " + std::to_string(i));
+      }
+      nodes[i] = arena.make<ast::BinaryExpression>(node.op, expression(node.a, i), expression(i - 1, i));
+      break;
+    case ast::NodeType::Identifier:
+      nodes[i] = arena.make<ast::Identifier>(atom(node.a, i));
+      break;
+    case ast::NodeType::NumericLiteral: {
+      if (node.a >= h.number_count || node.flags > 1) {
+        throw _malformed("node " + std::to_string(i));
+      }
+      const uint64_t bits = this->m_numbers[node.a];
+      NumberValue value;
+      if (node.flags) {
+        value.kind = NumberValue::Kind::Real;
+        std::memcpy(&value.real, &bits, sizeof(bits));
+      } else {
+        std::memcpy(&value.integer, &bits, sizeof(bits));
+      }
+      nodes[i] = arena.make<ast::NumericLiteral>(value);
+      break;
+    }
+    case ast::NodeType::StringLiteral:
+      nodes[i] = arena.make<ast::StringLiteral>(atom(node.a, i));
+      break;
+    default:
+      throw _malformed("node " + std::to_string(i));
+    }
+  }
+
+  auto* program = nodes.back();
+  if (program->type != ast::NodeType::Program) {
+    throw _malformed("no Program");
+  }
+  return static_cast<ast::Program*>(program);
+}
+
+} // namespace letter
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Arena.h"
+#include "Ast.h"
+#include "SymbolTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace letter {
+
+/**
+ * Binary AST: a flat, pointer free encoding of a Program and its symbol table,
+ * which can be read in place from a mapping of the file. In native (little-endian) byte order:
+ *   BinaryAstHeader
+ *   BinaryNode nodes[node_count]    postorder, children before their parent, the Program last
+ *   uint64_t numbers[number_count]  values of the NumericLiterals, the bits of an int64_t or a double
+ *   uint32_t lists[list_count]      statement lists of the Program and the blocks: a count, then node indices
+ *   uint32_t atoms[atom_count + 1]  offset of each atom string in `chars`, then the end
+ *   char chars[char_count]          the atom strings, back to back
+ * Any change of this layout bumps `kBinaryAstVersion`.
+ */
+constexpr uint32_t kBinaryAstVersion = 2;
+
+struct BinaryAstHeader {
+  char magic[4];          // "LTRA"
+  uint32_t version;       // kBinaryAstVersion
+  uint64_t source_hash;   // `hashSource` of the source it was parsed from
+  uint64_t source_size;
+  uint32_t node_count;
+  uint32_t list_count;
+  uint32_t atom_count;
+  uint32_t char_count;
+  uint32_t number_count;
+  uint32_t reserved;
+};
+
+/**
+ * @brief: a node, its children are indices of earlier nodes
+ * In postorder the last child of a node is the node just before it, so only the others are stored:
+ *   Program, BlockStatement: `a` the offset of its list in `lists`
+ *   ExpressionStatement: the expression is the node before
+ *   AssignmentExpression, BinaryExpression: `op`, `a` left, the right one is the node before
+ *   Identifier, StringLiteral: `a` atom
+ *   NumericLiteral: `a` index of its value in `numbers`, `flags` 1 if it is a double
+ */
+struct BinaryNode {
+  ast::NodeType type;
+  ast::Operator op;
+  uint16_t flags;
+  uint32_t a;
+};
+
+static_assert(sizeof(BinaryAstHeader) == 48 && sizeof(BinaryNode) == 8, "binary ast layout");
+
+/**
+ * @brief: hash of the source bytes, the key of a parse in a `ParseCache`
+ */
+uint64_t hashSource(std::string_view source);
+
+/**
+ * @brief: encode `program` with the atoms of `symbols`, parsed from a source of `source_size` bytes
+ * which `hashSource` hashes to `source_hash`
+ */
+std::string encodeBinaryAst(const ast::Program& program, const SymbolTable& symbols, 
+    uint64_t source_hash, uint64_t source_size);
+
+/**
+ * @brief: checked view of an encoded Binary AST, in place
+ * throw `letter::Exception` if `bytes` is not one of this version, or is truncated
+ */
+class BinaryAstView {
+private:
+  std::string_view m_bytes;
+  const BinaryAstHeader* m_header;
+  const BinaryNode* m_nodes;
+  const uint64_t* m_numbers;
+  const uint32_t* m_lists;
+  const uint32_t* m_atoms;
+  const char* m_chars;
+
+public:
+  explicit BinaryAstView(std::string_view bytes);
+
+  inline const BinaryAstHeader& header() const { return *this->m_header; }
+  inline const BinaryNode& node(uint32_t index) const { return this->m_nodes[index]; }
+  inline uint64_t number(uint32_t index) const { return this->m_numbers[index]; }
+  // the statement list at `offset`: its count, then the node indices
+  inline const uint32_t* list(uint32_t offset) const { return this->m_lists + offset; }
+
+  inline std::string_view atom(uint32_t atom) const {
+    return std::string_view(this->m_chars + this->m_atoms[atom], this->m_atoms[atom + 1] - this->m_atoms[atom]);
+  }
+
+  /**
+   * @brief: build the tree back into `arena`, and its atoms into `symbols`, which are cleared first
+   * throw `letter::Exception` if a node is malformed
+   */
+  ast::Program* decode(Arena& arena, SymbolTable& symbols) const;
+};
+
+} // namespace letter
@@ -0,0 +1,51 @@
+#include "Bytecode.h"
+
+#include <cstdio>
+
+namespace letter {
+
+const char* opCodeName(OpCode op) {
+  switch (op) {
+  case OpCode::Constant: return "CONSTANT";
+  case OpCode::Load:     return "LOAD";
+  case OpCode::Store:    return "STORE";
+  case OpCode::Add:      return "ADD";
+  case OpCode::Sub:      return "SUB";
+  case OpCode::Mul:      return "MUL";
+  case OpCode::Div:      return "DIV";
+  case OpCode::Complete: return "COMPLETE";
+  case OpCode::Return:   return "RETURN";
+  }
+  return "UNKNOWN";
+}
+
+std::string disassemble(const Chunk& chunk) {
+  std::string out;
+  char line[64];
+
+  for (std::size_t offset = 0; offset < chunk.code.size(); ) {
+    auto op = static_cast<OpCode>(chunk.code[offset]);
+
+    if (op == OpCode::Constant || op == OpCode::Load || op == OpCode::Store) {
+      uint32_t operand = readOperand(&chunk.code[offset + 1]);
+      std::snprintf(line, sizeof(line), "%04zu  %-12s %-4u ; ", offset, opCodeName(op), operand);
+      out += line;
+      if (op == OpCode::Constant) {
+        auto&& constant = chunk.constants[operand];
+        out += constant.isString() ? "'" + constant.asString() + "'" : constant.toString();
+      } else {
+        out += chunk.slot_names[operand];
+      }
+      out += "\n";
+      offset += 5;
+    } else {
+      std::snprintf(line, sizeof(line), "%04zu  %s\n", offset, opCodeName(op));
+      out += line;
+      offset += 1;
+    }
+  }
+
+  return out;
+}
+
+} // namespace letter
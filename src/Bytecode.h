@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Value.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace letter {
+
+/**
+ * @brief: instructions of the stack VM, one byte each, followed by their operands
+ * operands are 32 bit little endian, the comment gives the operands and the stack effect
+ */
+enum class OpCode : uint8_t {
+  Constant,   // u32 index: push constants[index]
+  Load,       // u32 slot: push slots[slot], error if it was never assigned
+  Store,      // u32 slot: slots[slot] = top, the value stays on the stack
+  Add,        // pop right, pop left, push left + right
+  Sub,        // pop right, pop left, push left - right
+  Mul,        // pop right, pop left, push left * right
+  Div,        // pop right, pop left, push left / right
+  Complete,   // pop into the completion value (end of an expression statement)
+  Return,     // end of the program, return the completion value
+};
+
+const char* opCodeName(OpCode op);
+
+/**
+ * @brief: a compiled program, independent of the parser which produced it
+ */
+struct Chunk {
+  std::vector<uint8_t> code;
+  std::vector<Value> constants;
+  std::vector<std::string> slot_names;  // name of each variable slot
+  uint32_t max_stack = 0;               // deepest stack the code reaches
+
+  inline void emit(OpCode op) {
+    this->code.push_back(static_cast<uint8_t>(op));
+  }
+
+  inline void emit(OpCode op, uint32_t operand) {
+    this->emit(op);
+    uint8_t bytes[4];
+    std::memcpy(bytes, &operand, sizeof(operand));
+    this->code.insert(this->code.end(), bytes, bytes + 4);
+  }
+};
+
+inline uint32_t readOperand(const uint8_t* p) {
+  uint32_t operand;
+  std::memcpy(&operand, p, sizeof(operand));
+  return operand;
+}
+
+/**
+ * @brief: one instruction per line: offset, name, operand and what the operand stands for, e.g.
+ * 0005  STORE        0    ; x
+ */
+std::string disassemble(const Chunk& chunk);
+
+} // namespace letter
@@ -0,0 +1,153 @@
+#include "Compiler.h"
+#include "Exception.h"
+#include "Profiler.h"
+#include "Resolver.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+namespace letter {
+
+namespace {
+
+class _Compiler {
+private:
+  const SymbolTable& m_symbols;
+  Chunk& m_chunk;
+
+  std::unordered_map<double, uint32_t> m_number_constants;
+  std::unordered_map<Atom, uint32_t> m_string_constants;
+
+  uint32_t m_depth; // current stack depth
+
+public:
+  _Compiler(const SymbolTable& symbols, Chunk& chunk)
+    : m_symbols(symbols), m_chunk(chunk), m_depth(0) {}
+
+  void statement(const ast::Statement* statement) {
+    switch (statement->type) {
+    case ast::NodeType::ExpressionStatement:
+      this->expression(static_cast<const ast::ExpressionStatement*>(statement)->expression);
+      this->_emit(OpCode::Complete, -1);
+      break;
+
+    case ast::NodeType::BlockStatement:
+      for (auto* child : static_cast<const ast::BlockStatement*>(statement)->statements()) {
+        this->statement(child);
+      }
+      break;
+
+    default: // EmptyStatement
+      break;
+    }
+  }
+
+  void expression(const ast::Expression* expression) {
+    switch (expression->type) {
+    case ast::NodeType::NumericLiteral: {
+      double number = static_cast<const ast::NumericLiteral*>(expression)->value.toDouble();
+      auto&& [it, added] = this->m_number_constants.emplace(number, this->_constantCount());
+      if (added) {
+        this->m_chunk.constants.emplace_back(number);
+      }
+      this->_emit(OpCode::Constant, it->second, 1);
+      break;
+    }
+
+    case ast::NodeType::StringLiteral: {
+      Atom atom = static_cast<const ast::StringLiteral*>(expression)->value;
+      auto&& [it, added] = this->m_string_constants.emplace(atom, this->_constantCount());
+      if (added) {
+        this->m_chunk.constants.emplace_back(this->m_symbols.name(atom));
+      }
+      this->_emit(OpCode::Constant, it->second, 1);
+      break;
+    }
+
+    case ast::NodeType::Identifier:
+      this->_emit(OpCode::Load, static_cast<const ast::Identifier*>(expression)->slot, 1);
+      break;
+
+    case ast::NodeType::BinaryExpression: {
+      auto* e = static_cast<const ast::BinaryExpression*>(expression);
+      this->expression(e->left);
+      this->expression(e->right);
+      this->_emit(_arithmetic(e->op), -1);
+      break;
+    }
+
+    case ast::NodeType::AssignmentExpression: {
+      auto* e = static_cast<const ast::AssignmentExpression*>(expression);
+      uint32_t slot = static_cast<const ast::Identifier*>(e->left)->slot;
+
+      if (e->op == ast::Operator::Assign) {
+        this->expression(e->right);
+      } else {
+        // compound assignment, `x += e` is `x = x + e`
+        this->_emit(OpCode::Load, slot, 1);
+        this->expression(e->right);
+        this->_emit(_arithmetic(e->op), -1);
+      }
+      this->_emit(OpCode::Store, slot, 0);
+      break;
+    }
+
+    default:
+      throw Exception(std::string("Can not compile node: ") + ast::nodeTypeName(expression->type));
+    }
+  }
+
+  void finish() {
+    this->_emit(OpCode::Return, 0);
+  }
+
+private:
+  uint32_t _constantCount() const {
+    return static_cast<uint32_t>(this->m_chunk.constants.size());
+  }
+
+  static OpCode _arithmetic(ast::Operator op) {
+    switch (arithmeticOperator(op)) {
+    case ast::Operator::Add: return OpCode::Add;
+    case ast::Operator::Sub: return OpCode::Sub;
+    case ast::Operator::Mul: return OpCode::Mul;
+    default:                 return OpCode::Div;
+    }
+  }
+
+  void _track(int stack_effect) {
+    this->m_depth += stack_effect;
+    this->m_chunk.max_stack = std::max(this->m_chunk.max_stack, this->m_depth);
+  }
+
+  void _emit(OpCode op, int stack_effect) {
+    this->m_chunk.emit(op);
+    this->_track(stack_effect);
+  }
+
+  void _emit(OpCode op, uint32_t operand, int stack_effect) {
+    this->m_chunk.emit(op, operand);
+    this->_track(stack_effect);
+  }
+};
+
+} // namespace
+
+Chunk compile(ast::Program& program, const SymbolTable& symbols) {
+  LETTER_PROFILE_ZONE("compile");
+  Chunk chunk;
+  for (Atom atom : resolveSlots(program, symbols)) {
+    chunk.slot_names.emplace_back(symbols.name(atom));
+  }
+
+  _Compiler compiler(symbols, chunk);
+  for (auto* statement : program.body) {
+    compiler.statement(statement);
+  }
+  compiler.finish();
+
+  return chunk;
+}
+
+} // namespace letter
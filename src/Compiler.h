@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Ast.h"
+#include "Bytecode.h"
+#include "SymbolTable.h"
+
+namespace letter {
+
+/**
+ * @brief: lower a parsed Program into bytecode for the `VM`
+ * The variables are resolved to slots first (see `resolveSlots`), which annotates `program` in place.
+ * The chunk does not reference the parser, it can be run any number of times after the parse is gone.
+ */
+Chunk compile(ast::Program& program, const SymbolTable& symbols);
+
+} // namespace letter
@@ -0,0 +1,48 @@
+#include "Diagnostic.h"
+#include "Ast.h"
+
+namespace letter {
+
+Diagnostics::Diagnostics(std::size_t limit) : m_limit(limit), m_dropped(0) {
+  this->m_list.reserve(limit);
+}
+
+std::string diagnosticMessage(const Diagnostic& diagnostic, std::string_view source, const SymbolTable& symbols) {
+  auto&& text = source.substr(diagnostic.offset, diagnostic.length);
+  switch (diagnostic.kind) {
+  case DiagnosticKind::UnexpectedToken:
+    return "Unexpected token: " + json::value(std::string(text)).to_string() + 
+        ", expected: " + tokenTypeName(diagnostic.expected);
+
+  case DiagnosticKind::UnexpectedEndOfInput:
+    return std::string("Unexpected end of input, expected: ") + tokenTypeName(diagnostic.expected);
+
+  case DiagnosticKind::InvalidCharacter:
+    // the first char, an unclosed string spans the rest of its line
+    return "Unexpected token: \"" + std::string(text.substr(0, 1)) + "\"";
+
+  case DiagnosticKind::InvalidAssignmentTarget:
+    return "Invalid left-hand side in assignment expression:\n" + ast::toJson(*diagnostic.target, symbols).to_string();
+
+  case DiagnosticKind::NumberOutOfRange:
+    return "Number out of range: " + std::string(text);
+  }
+  return "Unknown diagnostic";
+}
+
+json::value toJson(const Diagnostic& diagnostic, std::string_view source, const SymbolTable& symbols,
+    const LineIndex* lines/*= nullptr*/) {
+  json::object object{
+    {"message", diagnosticMessage(diagnostic, source, symbols)},
+    {"offset", static_cast<unsigned long long>(diagnostic.offset)},
+    {"length", static_cast<unsigned long long>(diagnostic.length)},
+  };
+  if (lines) {
+    auto&& position = lines->position(static_cast<uint32_t>(diagnostic.offset));
+    object["line"] = position.line;
+    object["column"] = position.column;
+  }
+  return object;
+}
+
+} // namespace letter
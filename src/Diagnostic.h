@@ -0,0 +1,97 @@
+#pragma once
+
+#include "json.hpp"
+#include "SourceLocation.h"
+#include "SymbolTable.h"
+#include "Token.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace letter {
+
+namespace ast {
+struct Expression;
+}
+
+/**
+ * @brief: what went wrong, each kind is one of the errors the throwing parse raises
+ */
+enum class DiagnosticKind : uint8_t {
+  UnexpectedToken,          // a token the grammar does not allow here, `expected` was
+  UnexpectedEndOfInput,     // the source ended, `expected` was
+  InvalidCharacter,         // no token starts here: a stray char, or a string not closed on its line
+  InvalidAssignmentTarget,  // the left side of an assignment is not an Identifier
+  NumberOutOfRange,         // a NUMBER which does not fit an int64_t, or a double
+};
+
+/**
+ * @brief: a syntax error found by a parse in diagnostics mode
+ * It is recorded as positions only, `diagnosticMessage` builds its text on demand.
+ */
+struct Diagnostic {
+  DiagnosticKind kind;
+  TokenKind expected = TokenKind::EndOfFile;
+  std::size_t offset = 0;                   // into the source
+  std::size_t length = 0;
+  const ast::Expression* target = nullptr;  // InvalidAssignmentTarget, lives in the arena of the parse
+};
+
+/**
+ * @brief: the diagnostics of a parse, in source order, up to a limit
+ * The storage is allocated once, for `limit` diagnostics, and kept by `clear`:
+ * recording one never allocates. Diagnostics past the limit are only counted.
+ */
+class Diagnostics {
+private:
+  std::vector<Diagnostic> m_list;
+  std::size_t m_limit;
+  std::size_t m_dropped;
+
+public:
+  static constexpr std::size_t kDefaultLimit = 256;
+
+  explicit Diagnostics(std::size_t limit = kDefaultLimit);
+
+  inline void add(const Diagnostic& diagnostic) {
+    if (this->m_list.size() < this->m_limit) {
+      this->m_list.push_back(diagnostic);
+    } else {
+      ++ this->m_dropped;
+    }
+  }
+
+  inline void clear() {
+    this->m_list.clear();
+    this->m_dropped = 0;
+  }
+
+  inline bool empty() const { return this->m_list.empty(); }
+  inline std::size_t size() const { return this->m_list.size(); }
+  inline const Diagnostic& operator[](std::size_t i) const { return this->m_list[i]; }
+  inline std::vector<Diagnostic>::const_iterator begin() const { return this->m_list.begin(); }
+  inline std::vector<Diagnostic>::const_iterator end() const { return this->m_list.end(); }
+
+  /**
+   * @brief: diagnostics found past the limit, not recorded
+   */
+  inline std::size_t dropped() const { return this->m_dropped; }
+};
+
+/**
+ * @brief: text of `diagnostic`, the same as the message of the exception the throwing parse raises
+ * `source` and `symbols` are those of the parse which recorded it.
+ */
+std::string diagnosticMessage(const Diagnostic& diagnostic, std::string_view source, const SymbolTable& symbols);
+
+/**
+ * @brief: {"message": ..., "offset": ..., "length": ...}
+ * With the `lines` of the source, also the "line" and "column" of the offset.
+ */
+json::value toJson(const Diagnostic& diagnostic, std::string_view source, const SymbolTable& symbols,
+    const LineIndex* lines = nullptr);
+
+} // namespace letter
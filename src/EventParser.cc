@@ -0,0 +1,256 @@
+#include "EventParser.h"
+#include "Exception.h"
+#include "Parser.h"
+
+#include <string>
+
+namespace letter {
+
+EventParser::EventParser()
+  : m_visitor(nullptr), m_released(0) {
+
+}
+
+void EventParser::parse(std::string_view source, ParseVisitor& visitor) {
+  this->m_source = SourceBuffer();
+  this->m_text = source;
+  this->_parse(visitor);
+}
+
+void EventParser::parseFile(const std::string& path, ParseVisitor& visitor) {
+  this->m_source = SourceBuffer::fromFile(path);
+  this->m_text = this->m_source.view();
+  this->_parse(visitor);
+  this->m_source = SourceBuffer();
+}
+
+void EventParser::_parse(ParseVisitor& visitor) {
+  this->m_visitor = &visitor;
+  this->m_released = 0;
+
+  this->m_tokenizer.initView(this->m_text);
+  this->m_lookahead = this->m_tokenizer.getNextToken();
+  this->Program();
+}
+
+/**
+ * @brief: give back the pages of a mapped source before the lookahead, they are never read again
+ */
+void EventParser::_releaseParsed() {
+  if (!this->m_source.isMapped()) {
+    return;
+  }
+  const std::size_t offset = this->m_lookahead.empty() ? this->m_text.size() 
+    : this->m_lookahead.value.data() - this->m_text.data();
+  if (offset - this->m_released >= kReleaseStep) {
+    this->m_source.releaseBefore(offset);
+    this->m_released = offset;
+  }
+}
+
+/**
+ * Program
+ *  : StatementList
+ *  ;
+ */
+void EventParser::Program() {
+  this->m_visitor->onProgramBegin();
+  this->StatementList(TokenKind::EndOfFile);
+  this->m_visitor->onProgramEnd();
+}
+
+/**
+ * StatementList
+ *  : Statement
+ *  | StatementList Statement
+ *  ;
+ */
+void EventParser::StatementList(TokenKind stop_lookahead_tokenkind) {
+  do {
+    this->Statement();
+    this->_releaseParsed();
+  } while (!this->m_lookahead.empty() && this->m_lookahead.kind != stop_lookahead_tokenkind);
+}
+
+/**
+ * Statement
+ *  : ExpressionStatement
+ *  | BlockStatement
+ *  | EmptyStatement
+ *  ;
+ */
+void EventParser::Statement() {
+  auto kind = this->m_lookahead.kind;
+  if (kind == TokenKind::LeftBrace) {
+    this->BlockStatement();
+  } else if (kind == TokenKind::Semicolon) {
+    this->EmptyStatement();
+  } else {
+    this->ExpressionStatement();
+  }
+}
+
+/**
+ * ExpressionStatement
+ *  : Expression ";"
+ *  ;
+ */
+void EventParser::ExpressionStatement() {
+  this->m_visitor->onStatementBegin(ast::NodeType::ExpressionStatement);
+  this->Expression();
+  this->_eat(TokenKind::Semicolon);
+  this->m_visitor->onStatementEnd(ast::NodeType::ExpressionStatement);
+}
+
+/**
+ * BlockStatement
+ *  : "{" OptStatementList "}"
+ *  ;
+ */
+void EventParser::BlockStatement() {
+  this->m_visitor->onStatementBegin(ast::NodeType::BlockStatement);
+  this->_eat(TokenKind::LeftBrace);
+  if (this->m_lookahead.kind != TokenKind::RightBrace) {
+    this->StatementList(TokenKind::RightBrace);
+  }
+  this->_eat(TokenKind::RightBrace);
+  this->m_visitor->onStatementEnd(ast::NodeType::BlockStatement);
+}
+
+/**
+ * EmptyStatement
+ *  : ";"
+ *  ;
+ */
+void EventParser::EmptyStatement() {
+  this->m_visitor->onStatementBegin(ast::NodeType::EmptyStatement);
+  this->_eat(TokenKind::Semicolon);
+  this->m_visitor->onStatementEnd(ast::NodeType::EmptyStatement);
+}
+
+/**
+ * Expression
+ *  : BinaryExpression(lowest precedence)
+ *  ;
+ */
+ast::NodeType EventParser::Expression() {
+  return this->BinaryExpression(1);
+}
+
+/**
+ * BinaryExpression(min_precedence), precedence climbing over the operator table of `Parser`, see `operatorInfo`
+ * the operands are reported before their operator
+ */
+ast::NodeType EventParser::BinaryExpression(uint8_t min_precedence) {
+  const std::size_t start = this->m_lookahead.offset; // of `left`
+  auto left = this->PrimaryExpression();
+
+  while (true) {
+    auto&& info = operatorInfo(this->m_lookahead.kind);
+    if (info.precedence == 0 || info.precedence < min_precedence) {
+      break;
+    }
+
+    auto op_token = this->_eat(this->m_lookahead.kind);
+    auto op = ast::operatorFromText(op_token.value);
+
+    if (info.assignment) {
+      if (left != ast::NodeType::Identifier) {
+        this->_throwInvalidTarget(start, op_token.offset);
+      }
+      this->BinaryExpression(info.precedence);
+      this->m_visitor->onAssignmentExpression(op);
+      left = ast::NodeType::AssignmentExpression;
+      continue;
+    }
+
+    this->BinaryExpression(info.right_associative ? info.precedence : info.precedence + 1);
+    this->m_visitor->onBinaryExpression(op);
+    left = ast::NodeType::BinaryExpression;
+  }
+
+  return left;
+}
+
+/**
+ * PrimaryExpression
+ *  : Literal
+ *  | ParenthesizedExpression
+ *  | Identifier
+ *  ;
+ */
+ast::NodeType EventParser::PrimaryExpression() {
+  auto kind = this->m_lookahead.kind;
+  if (kind == TokenKind::Number || kind == TokenKind::String) {
+    return this->Literal();
+  }
+
+  if (kind == TokenKind::LeftParen) {
+    return this->ParenthesizedExpression();
+  } else {
+    return this->Identifier();
+  }
+}
+
+/**
+ * ParenthesizedExpression
+ *  : "(" Expression ")"
+ *  ;
+ */
+ast::NodeType EventParser::ParenthesizedExpression() {
+  this->_eat(TokenKind::LeftParen);
+  auto type = this->Expression();
+  this->_eat(TokenKind::RightParen);
+  return type;
+}
+
+ast::NodeType EventParser::Identifier() {
+  auto name = this->_eat(TokenKind::Identifier);
+  this->m_visitor->onIdentifier(name.value);
+  return ast::NodeType::Identifier;
+}
+
+ast::NodeType EventParser::Literal() {
+  if (this->m_lookahead.kind == TokenKind::Number) {
+    auto token = this->_eat(TokenKind::Number);
+    if (token.number.kind == NumberValue::Kind::OutOfRange) {
+      throw Exception("Number out of range: " + std::string(token.value));
+    }
+    this->m_visitor->onNumericLiteral(token.number);
+    return ast::NodeType::NumericLiteral;
+  }
+
+  auto token = this->_eat(TokenKind::String);
+  this->m_visitor->onStringLiteral(token.value.substr(1, token.value.size() - 2));
+  return ast::NodeType::StringLiteral;
+}
+
+Token EventParser::_eat(TokenKind token_kind) {
+  auto token = this->m_lookahead;
+
+  if (token.empty()) {
+    throw Exception(std::string("Unexpected end of input, expected: ") + tokenTypeName(token_kind));
+  }
+
+  if (token.kind != token_kind) {
+    throw Exception("Unexpected token: " + json::value(std::string(token.value)).to_string() + 
+        ", expected: " + tokenTypeName(token_kind));
+  }
+
+  this->m_lookahead = this->m_tokenizer.getNextToken();
+  return token;
+}
+
+/**
+ * @brief: the error of `Parser` for an invalid assignment target shows the target as json,
+ * which was never built here: parse the text of the target alone, from `start` to the operator at `end`
+ */
+void EventParser::_throwInvalidTarget(std::size_t start, std::size_t end) {
+  Parser parser;
+  auto* program = parser.parseAst(std::string(this->m_text.substr(start, end - start)) + ";");
+  auto* statement = ast::cast<ast::ExpressionStatement>(program->body[0]);
+  throw Exception("Invalid left-hand side in assignment expression:\n" + 
+      ast::toJson(*statement->expression, parser.symbols()).to_string());
+}
+
+} // namespace letter
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Ast.h"
+#include "SourceBuffer.h"
+#include "Tokenizer.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace letter {
+
+/**
+ * @brief: receives the events of an `EventParser`, every callback does nothing by default
+ * Statements are bracketed by a begin and an end event, the statements of a block come in
+ * between. Expressions come in postorder: the operands first, then the operator, e.g.
+ * `a = b + 1;` is Identifier(a) Identifier(b) NumericLiteral(1) BinaryExpression(+)
+ * AssignmentExpression(=). Views passed to a callback are only valid during the call.
+ */
+class ParseVisitor {
+public:
+  virtual ~ParseVisitor() = default;
+
+  virtual void onProgramBegin() {}
+  virtual void onProgramEnd() {}
+
+  // ExpressionStatement, BlockStatement or EmptyStatement
+  virtual void onStatementBegin(ast::NodeType /*type*/) {}
+  virtual void onStatementEnd(ast::NodeType /*type*/) {}
+
+  virtual void onBinaryExpression(ast::Operator /*op*/) {}
+  virtual void onAssignmentExpression(ast::Operator /*op*/) {}
+  virtual void onIdentifier(std::string_view /*name*/) {}
+  virtual void onNumericLiteral(NumberValue /*value*/) {}
+  virtual void onStringLiteral(std::string_view /*value*/) {} // contents, without the quotes
+};
+
+/**
+ * @brief: parses like `Parser` but builds no tree, it reports what it parses to a `ParseVisitor`
+ * Nothing is kept of what was parsed: no node, no atom, and the pages of a mapped file are
+ * given back once parsed, so memory grows with the nesting depth only, not with the source.
+ * Errors are the ones `Parser` throws, after the events of everything parsed before them.
+ */
+class EventParser {
+private:
+  SourceBuffer m_source;
+  std::string_view m_text;
+  Tokenizer m_tokenizer;
+  Token m_lookahead;
+  ParseVisitor* m_visitor;
+
+  std::size_t m_released;         // the mapped source before this offset was given back
+
+public:
+  // give the parsed pages of a mapped file back about every this many bytes
+  static constexpr std::size_t kReleaseStep = 4 * 1024 * 1024;
+
+  EventParser();
+
+  /**
+   * @brief: parse `source` in place, the caller keeps it alive during the call
+   */
+  void parse(std::string_view source, ParseVisitor& visitor);
+
+  /**
+   * @brief: parse the file at `path` from a read-only mapping of it, see `SourceBuffer::fromFile`
+   */
+  void parseFile(const std::string& path, ParseVisitor& visitor);
+
+private:
+  void _parse(ParseVisitor& visitor);
+
+  void Program();
+  void StatementList(TokenKind stop_lookahead_tokenkind);
+  void Statement();
+  void ExpressionStatement();
+  void BlockStatement();
+  void EmptyStatement();
+
+  // each returns the type of the node `Parser` would build
+  ast::NodeType Expression();
+  ast::NodeType BinaryExpression(uint8_t min_precedence);
+  ast::NodeType PrimaryExpression();
+  ast::NodeType ParenthesizedExpression();
+  ast::NodeType Identifier();
+  ast::NodeType Literal();
+
+  Token _eat(TokenKind token_kind);
+  void _releaseParsed();
+  [[noreturn]] void _throwInvalidTarget(std::size_t start, std::size_t end);
+};
+
+} // namespace letter
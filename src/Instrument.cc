@@ -0,0 +1,176 @@
+#include "Instrument.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace letter {
+namespace instrument {
+
+const char* phaseName(Phase phase) {
+  switch (phase) {
+  case Phase::Other:     return "other";
+  case Phase::Tokenize:  return "tokenize";
+  case Phase::Parse:     return "parse";
+  case Phase::Serialize: return "serialize";
+  }
+  return "unknown";
+}
+
+json::value Stats::toJson() const {
+  json::object phases;
+  for (std::size_t i = 0; i < kPhaseCount; ++i) {
+    auto&& phase = this->phases[i];
+    phases[phaseName(static_cast<Phase>(i))] = json::object{
+      {"count", static_cast<unsigned long long>(phase.count)},
+      {"bytes", static_cast<unsigned long long>(phase.bytes)},
+      {"live_bytes", static_cast<unsigned long long>(phase.live_bytes)},
+      {"peak_live_bytes", static_cast<unsigned long long>(phase.peak_live_bytes)},
+    };
+  }
+
+  json::object nodes;
+  for (std::size_t i = 0; i < kNodeTypeCount; ++i) {
+    auto&& node = this->nodes[i];
+    nodes[ast::nodeTypeName(static_cast<ast::NodeType>(i))] = json::object{
+      {"count", static_cast<unsigned long long>(node.count)},
+      {"bytes", static_cast<unsigned long long>(node.bytes)},
+    };
+  }
+
+  return json::object{
+    {"enabled", kEnabled},
+    {"phases", phases},
+    {"nodes", nodes},
+  };
+}
+
+#if LETTER_INSTRUMENT
+
+struct _PhaseCounters {
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<int64_t> live_bytes{0};   // may go below 0 in a phase: freed there, allocated in another
+  std::atomic<int64_t> peak_live_bytes{0};
+};
+
+struct _NodeCounters {
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> bytes{0};
+};
+
+// constant initialized, they work for the allocations made before main
+static _PhaseCounters s_phases[kPhaseCount];
+static _NodeCounters s_nodes[kNodeTypeCount];
+static thread_local Phase t_phase = Phase::Other;
+
+Phase exchangePhase(Phase phase) {
+  Phase previous = t_phase;
+  t_phase = phase;
+  return previous;
+}
+
+void countNode(ast::NodeType type, std::size_t bytes) {
+  auto&& node = s_nodes[static_cast<std::size_t>(type)];
+  node.count.fetch_add(1, std::memory_order_relaxed);
+  node.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+Stats snapshot() {
+  Stats stats;
+  for (std::size_t i = 0; i < kPhaseCount; ++i) {
+    auto&& phase = s_phases[i];
+    stats.phases[i].count = phase.count.load(std::memory_order_relaxed);
+    stats.phases[i].bytes = phase.bytes.load(std::memory_order_relaxed);
+    stats.phases[i].live_bytes = static_cast<uint64_t>(std::max<int64_t>(0, phase.live_bytes.load()));
+    stats.phases[i].peak_live_bytes = static_cast<uint64_t>(std::max<int64_t>(0, phase.peak_live_bytes.load()));
+  }
+  for (std::size_t i = 0; i < kNodeTypeCount; ++i) {
+    stats.nodes[i].count = s_nodes[i].count.load(std::memory_order_relaxed);
+    stats.nodes[i].bytes = s_nodes[i].bytes.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void reset() {
+  for (auto&& phase : s_phases) {
+    phase.count = 0;
+    phase.bytes = 0;
+    phase.live_bytes = 0;
+    phase.peak_live_bytes = 0;
+  }
+  for (auto&& node : s_nodes) {
+    node.count = 0;
+    node.bytes = 0;
+  }
+}
+
+/**
+ * @brief: every block starts with this header, so that delete knows its size and phase
+ * 16 bytes, the alignment malloc gives is kept
+ */
+struct alignas(16) _Header {
+  std::size_t size;
+  Phase phase;
+};
+
+static void* _allocate(std::size_t size) {
+  auto* header = static_cast<_Header*>(std::malloc(sizeof(_Header) + size));
+  if (!header) {
+    throw std::bad_alloc();
+  }
+  header->size = size;
+  header->phase = t_phase;
+
+  auto&& phase = s_phases[static_cast<std::size_t>(header->phase)];
+  phase.count.fetch_add(1, std::memory_order_relaxed);
+  phase.bytes.fetch_add(size, std::memory_order_relaxed);
+  const int64_t live = phase.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+  int64_t peak = phase.peak_live_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !phase.peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+  }
+  return header + 1;
+}
+
+static void _free(void* p) {
+  if (!p) {
+    return;
+  }
+  auto* header = static_cast<_Header*>(p) - 1;
+  s_phases[static_cast<std::size_t>(header->phase)].live_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+  std::free(header);
+}
+
+#endif // LETTER_INSTRUMENT
+
+} // namespace instrument
+} // namespace letter
+
+#if LETTER_INSTRUMENT
+
+// the replaceable global allocation functions, the over-aligned ones are left to the standard library
+void* operator new(std::size_t size) { return letter::instrument::_allocate(size); }
+void* operator new[](std::size_t size) { return letter::instrument::_allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return letter::instrument::_allocate(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return letter::instrument::_allocate(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+void operator delete(void* p) noexcept { letter::instrument::_free(p); }
+void operator delete[](void* p) noexcept { letter::instrument::_free(p); }
+void operator delete(void* p, std::size_t) noexcept { letter::instrument::_free(p); }
+void operator delete[](void* p, std::size_t) noexcept { letter::instrument::_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { letter::instrument::_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { letter::instrument::_free(p); }
+
+#endif
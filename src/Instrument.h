@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Ast.h"
+#include "json.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Instrumentation build: configure with -DLETTER_INSTRUMENT=ON.
+ * The library then replaces the global operator new and delete to count every heap
+ * allocation of the process by phase, and the parser counts the nodes it builds by type.
+ * Off by default: every hook below is then an empty inline function, and costs nothing.
+ */
+#ifndef LETTER_INSTRUMENT
+#define LETTER_INSTRUMENT 0
+#endif
+
+namespace letter {
+namespace instrument {
+
+constexpr bool kEnabled = LETTER_INSTRUMENT;
+
+/**
+ * @brief: what the running thread is doing, its allocations are counted there
+ */
+enum class Phase : uint8_t {
+  Other,      // none of the below
+  Tokenize,   // inside `Tokenizer::getNextToken`
+  Parse,      // the rest of a parse
+  Serialize,  // `ast::toJson`
+};
+
+constexpr std::size_t kPhaseCount = 4;
+constexpr std::size_t kNodeTypeCount = static_cast<std::size_t>(ast::NodeType::StringLiteral) + 1;
+
+const char* phaseName(Phase phase);
+
+struct AllocationStats {
+  uint64_t count = 0;             // operator new calls
+  uint64_t bytes = 0;             // bytes asked for
+  uint64_t live_bytes = 0;        // allocated in the phase, not freed yet
+  uint64_t peak_live_bytes = 0;   // highest `live_bytes` since the last reset
+};
+
+struct NodeStats {
+  uint64_t count = 0;             // nodes built by a parser
+  uint64_t bytes = 0;             // arena bytes they retain, their statement arrays included
+};
+
+struct Stats {
+  std::array<AllocationStats, kPhaseCount> phases;   // indexed by Phase
+  std::array<NodeStats, kNodeTypeCount> nodes;       // indexed by ast::NodeType
+
+  /**
+   * @brief: {"enabled": ..., "phases": {"parse": {"count": ...}...}, "nodes": {"Identifier": {...}...}}
+   */
+  json::value toJson() const;
+};
+
+#if LETTER_INSTRUMENT
+
+/**
+ * @brief: the counters since the last `reset`, all threads together
+ */
+Stats snapshot();
+
+/**
+ * @brief: zero the counters, live and peak bytes included
+ */
+void reset();
+
+/**
+ * @brief: make `phase` the phase of the calling thread, return the previous one
+ */
+Phase exchangePhase(Phase phase);
+
+void countNode(ast::NodeType type, std::size_t bytes);
+
+#else
+
+inline Stats snapshot() { return Stats{}; }
+inline void reset() {}
+inline Phase exchangePhase(Phase) { return Phase::Other; }
+inline void countNode(ast::NodeType, std::size_t) {}
+
+#endif
+
+/**
+ * @brief: the calling thread is in `phase` until the end of the scope
+ */
+class PhaseScope {
+private:
+  Phase m_previous;
+
+public:
+  explicit PhaseScope(Phase phase) : m_previous(exchangePhase(phase)) {}
+  ~PhaseScope() { exchangePhase(this->m_previous); }
+
+  PhaseScope(const PhaseScope&) = delete;
+  PhaseScope& operator=(const PhaseScope&) = delete;
+};
+
+} // namespace instrument
+} // namespace letter
@@ -0,0 +1,112 @@
+#include "Interpreter.h"
+#include "Exception.h"
+#include "Profiler.h"
+#include "Resolver.h"
+
+#include <string>
+
+namespace letter {
+
+Interpreter::Interpreter(ast::Program& program, const SymbolTable& symbols) 
+  : m_program(program), m_symbols(symbols), 
+    m_slot_names(resolveSlots(program, symbols)), m_slots(m_slot_names.size()),
+    m_statements(0) {
+
+}
+
+Value Interpreter::run() {
+  LETTER_PROFILE_ZONE("Interpreter::run");
+  Value completion;
+  for (auto* statement : this->m_program.body) {
+    LETTER_PROFILE_ZONE("Interpreter::statement");
+    this->_execute(statement, completion);
+  }
+  return completion;
+}
+
+std::optional<uint32_t> Interpreter::slotOf(std::string_view name) const {
+  for (uint32_t slot = 0; slot < this->m_slot_names.size(); ++slot) {
+    if (this->m_symbols.name(this->m_slot_names[slot]) == name) {
+      return slot;
+    }
+  }
+  return std::nullopt;
+}
+
+bool Interpreter::setVariable(std::string_view name, Value value) {
+  auto&& slot = this->slotOf(name);
+  if (!slot) {
+    return false;
+  }
+  this->m_slots[*slot] = std::move(value);
+  return true;
+}
+
+Value Interpreter::variable(std::string_view name) const {
+  auto&& slot = this->slotOf(name);
+  return slot ? this->m_slots[*slot] : Value{};
+}
+
+void Interpreter::_execute(const ast::Statement* statement, Value& completion) {
+  ++this->m_statements;
+
+  switch (statement->type) {
+  case ast::NodeType::ExpressionStatement:
+    completion = this->_evaluate(static_cast<const ast::ExpressionStatement*>(statement)->expression);
+    break;
+
+  case ast::NodeType::BlockStatement:
+    for (auto* child : static_cast<const ast::BlockStatement*>(statement)->statements()) {
+      this->_execute(child, completion);
+    }
+    break;
+
+  default: // EmptyStatement
+    break;
+  }
+}
+
+Value Interpreter::_evaluate(const ast::Expression* expression) {
+  switch (expression->type) {
+  case ast::NodeType::NumericLiteral:
+    return static_cast<const ast::NumericLiteral*>(expression)->value.toDouble();
+
+  case ast::NodeType::StringLiteral:
+    return this->m_symbols.name(static_cast<const ast::StringLiteral*>(expression)->value);
+
+  case ast::NodeType::Identifier: {
+    auto* identifier = static_cast<const ast::Identifier*>(expression);
+    auto&& value = this->m_slots[identifier->slot];
+    if (value.isUndefined()) {
+      throw Exception(std::string(this->m_symbols.name(identifier->name)) + " is not defined");
+    }
+    return value;
+  }
+
+  case ast::NodeType::BinaryExpression: {
+    auto* e = static_cast<const ast::BinaryExpression*>(expression);
+    auto&& left = this->_evaluate(e->left);
+    auto&& right = this->_evaluate(e->right);
+    return binaryOperation(e->op, left, right);
+  }
+
+  case ast::NodeType::AssignmentExpression: {
+    auto* e = static_cast<const ast::AssignmentExpression*>(expression);
+    auto* target = static_cast<const ast::Identifier*>(e->left);
+
+    if (e->op == ast::Operator::Assign) {
+      return this->m_slots[target->slot] = this->_evaluate(e->right);
+    }
+
+    // compound assignment, `x += e` is `x = x + e`
+    auto&& current = this->_evaluate(target);
+    auto&& right = this->_evaluate(e->right);
+    return this->m_slots[target->slot] = binaryOperation(e->op, current, right);
+  }
+
+  default:
+    throw Exception(std::string("Can not evaluate node: ") + ast::nodeTypeName(expression->type));
+  }
+}
+
+} // namespace letter
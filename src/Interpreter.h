@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Ast.h"
+#include "SymbolTable.h"
+#include "Value.h"
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace letter {
+
+/**
+ * @brief: tree-walking evaluator of a parsed Program
+ * Variables are resolved to fixed slots once, at construction; evaluation
+ * then reads and writes `m_slots[identifier->slot]`, never a name lookup.
+ * The program and its symbol table must outlive the interpreter.
+ */
+class Interpreter {
+private:
+  const ast::Program& m_program;
+  const SymbolTable& m_symbols;
+
+  std::vector<Atom> m_slot_names;   // name of each slot
+  std::vector<Value> m_slots;       // variable values, kept between runs
+
+  std::size_t m_statements;         // statements executed since construction
+
+public:
+  /**
+   * @brief: resolve the slots of `program`, annotating its identifiers in place
+   */
+  Interpreter(ast::Program& program, const SymbolTable& symbols);
+
+  /**
+   * @brief: execute the program
+   * @return: completion value, the value of the last expression statement executed
+   * throw `letter::Exception` on runtime errors, e.g. reading an unassigned variable
+   */
+  Value run();
+
+  /**
+   * @brief: slot of the variable `name`, std::nullopt if the program does not use it
+   */
+  std::optional<uint32_t> slotOf(std::string_view name) const;
+
+  inline std::size_t slotCount() const { return this->m_slots.size(); }
+
+  inline Value& slot(uint32_t slot) { return this->m_slots[slot]; }
+
+  /**
+   * @brief: set a variable by name before running, e.g. an input of the script
+   * @return: false if the program does not use `name`
+   */
+  bool setVariable(std::string_view name, Value value);
+
+  /**
+   * @brief: value of a variable by name, undefined if unknown or never assigned
+   */
+  Value variable(std::string_view name) const;
+
+  inline std::size_t statementsExecuted() const { return this->m_statements; }
+
+private:
+  void _execute(const ast::Statement* statement, Value& completion);
+  Value _evaluate(const ast::Expression* expression);
+};
+
+} // namespace letter
@@ -0,0 +1,312 @@
+#include "JsonWriter.h"
+#include "Exception.h"
+#include "Instrument.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+namespace letter {
+
+JsonWriter::JsonWriter(int fd, bool pretty/*= false*/, std::size_t buffer_size/*= kBufferSize*/)
+  : m_buffer(new char[std::max<std::size_t>(buffer_size, 1)]), m_capacity(std::max<std::size_t>(buffer_size, 1)),
+    m_size(0), m_fd(fd), m_stream(nullptr), m_pretty(pretty), m_written(0), m_after_key(false) {
+
+}
+
+JsonWriter::JsonWriter(std::ostream& stream, bool pretty/*= false*/, std::size_t buffer_size/*= kBufferSize*/)
+  : m_buffer(new char[std::max<std::size_t>(buffer_size, 1)]), m_capacity(std::max<std::size_t>(buffer_size, 1)),
+    m_size(0), m_fd(-1), m_stream(&stream), m_pretty(pretty), m_written(0), m_after_key(false) {
+
+}
+
+JsonWriter::~JsonWriter() {
+  try {
+    this->flush();
+  } catch (...) {
+  }
+}
+
+/**
+ * @brief: write `size` bytes to the file descriptor or the stream, unbuffered
+ */
+static void _write(int fd, std::ostream* stream, const char* data, std::size_t size) {
+  if (stream) {
+    stream->write(data, static_cast<std::streamsize>(size));
+    if (!*stream) {
+      throw Exception("Cannot write json: stream failed");
+    }
+    return;
+  }
+
+  while (size > 0) {
+    const ssize_t n = ::write(fd, data, size);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw Exception(std::string("Cannot write json: ") + std::strerror(errno));
+    }
+    data += n;
+    size -= static_cast<std::size_t>(n);
+  }
+}
+
+void JsonWriter::flush() {
+  LETTER_PROFILE_ZONE("JsonWriter::flush");
+  if (this->m_size == 0) {
+    return;
+  }
+  // the buffer is given up even if the write fails, a retry would write it twice
+  const std::size_t size = this->m_size;
+  this->m_size = 0;
+  this->m_written += size;
+  _write(this->m_fd, this->m_stream, this->m_buffer.get(), size);
+}
+
+void JsonWriter::_put(const char* data, std::size_t size) {
+  if (size > this->m_capacity - this->m_size) {
+    this->flush();
+    if (size > this->m_capacity) {
+      this->m_written += size;
+      _write(this->m_fd, this->m_stream, data, size);
+      return;
+    }
+  }
+  std::memcpy(this->m_buffer.get() + this->m_size, data, size);
+  this->m_size += size;
+}
+
+void JsonWriter::_indent(std::size_t depth) {
+  static const char s_spaces[] = "                                                                ";
+  for (std::size_t n = depth * 4; n > 0; ) {
+    const std::size_t step = std::min(n, sizeof(s_spaces) - 1);
+    this->_put(s_spaces, step);
+    n -= step;
+  }
+}
+
+/**
+ * @brief: the separator before a value or a key: none after a key, a comma after a previous element,
+ * and in pretty mode a new line indented to the depth
+ */
+void JsonWriter::_beforeValue() {
+  if (this->m_after_key) {
+    this->m_after_key = false;
+    return;
+  }
+  if (this->m_empty.empty()) {
+    return;
+  }
+  if (!this->m_empty.back()) {
+    this->_put(',');
+  }
+  this->m_empty.back() = false;
+  if (this->m_pretty) {
+    this->_put('\n');
+    this->_indent(this->m_empty.size());
+  }
+}
+
+void JsonWriter::beginObject() {
+  this->_beforeValue();
+  this->_put('{');
+  this->m_empty.push_back(true);
+}
+
+void JsonWriter::endObject() {
+  const bool empty = this->m_empty.back();
+  this->m_empty.pop_back();
+  if (this->m_pretty && !empty) {
+    this->_put('\n');
+    this->_indent(this->m_empty.size());
+  }
+  this->_put('}');
+}
+
+void JsonWriter::beginArray() {
+  this->_beforeValue();
+  this->_put('[');
+  this->m_empty.push_back(true);
+}
+
+void JsonWriter::endArray() {
+  const bool empty = this->m_empty.back();
+  this->m_empty.pop_back();
+  if (this->m_pretty && !empty) {
+    this->_put('\n');
+    this->_indent(this->m_empty.size());
+  }
+  this->_put(']');
+}
+
+void JsonWriter::key(std::string_view name) {
+  this->_beforeValue();
+  this->_string(name);
+  if (this->m_pretty) {
+    this->_put(": ", 2);
+  } else {
+    this->_put(':');
+  }
+  this->m_after_key = true;
+}
+
+void JsonWriter::value(std::string_view string) {
+  this->_beforeValue();
+  this->_string(string);
+}
+
+void JsonWriter::value(int64_t integer) {
+  this->_beforeValue();
+  char text[24];
+  auto&& [end, error] = std::to_chars(text, text + sizeof(text), integer);
+  this->_put(text, static_cast<std::size_t>(end - text));
+}
+
+void JsonWriter::value(double real) {
+  this->_beforeValue();
+  // rare in an ast, printed by the json library itself so that the text is the same
+  auto&& text = json::value(real).to_string();
+  this->_put(text.data(), text.size());
+}
+
+void JsonWriter::_string(std::string_view string) {
+  const bool plain = std::none_of(string.begin(), string.end(), [](char c) {
+    return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+  });
+  if (plain) {
+    this->_put('"');
+    this->_put(string.data(), string.size());
+    this->_put('"');
+    return;
+  }
+  // escaped by the json library itself, as `to_string` does
+  auto&& text = json::value(std::string(string)).to_string();
+  this->_put(text.data(), text.size());
+}
+
+void JsonWriter::_list(const ast::NodeList<ast::Statement>& list, const SymbolTable& symbols, const LineIndex* lines) {
+  this->beginArray();
+  for (auto* statement : list) {
+    this->writeAst(*statement, symbols, lines);
+  }
+  this->endArray();
+}
+
+void JsonWriter::_position(SourcePosition position) {
+  this->beginObject();
+  this->key("column");
+  this->value(static_cast<int64_t>(position.column));
+  this->key("line");
+  this->value(static_cast<int64_t>(position.line));
+  this->endObject();
+}
+
+/**
+ * @brief: "loc" of `node`, if there are `lines`
+ */
+void JsonWriter::_loc(const ast::Node& node, const LineIndex* lines) {
+  if (!lines) {
+    return;
+  }
+  this->key("loc");
+  this->beginObject();
+  this->key("end");
+  this->_position(lines->position(node.span.end()));
+  this->key("start");
+  this->_position(lines->position(node.span.offset));
+  this->endObject();
+}
+
+/**
+ * @brief: the keys of an AssignmentExpression or a BinaryExpression, which have the same ones
+ */
+template <typename E>
+void JsonWriter::_operation(const E& e, const SymbolTable& symbols, const LineIndex* lines) {
+  this->key("left");
+  this->writeAst(*e.left, symbols, lines);
+  this->_loc(e, lines);
+  this->key("operator");
+  this->value(std::string_view(ast::operatorText(e.op)));
+  this->key("right");
+  this->writeAst(*e.right, symbols, lines);
+  this->key("type");
+  this->value(std::string_view(ast::nodeTypeName(e.type)));
+}
+
+void JsonWriter::writeAst(const ast::Node& node, const SymbolTable& symbols, const LineIndex* lines/*= nullptr*/) {
+  instrument::PhaseScope phase(instrument::Phase::Serialize);
+  using namespace ast;
+
+  // the keys of a json::object come out sorted, "loc" goes where it sorts
+  auto&& type = [&]() {
+    this->key("type");
+    this->value(std::string_view(nodeTypeName(node.type)));
+  };
+
+  this->beginObject();
+  switch (node.type) {
+  case NodeType::Program:
+  case NodeType::BlockStatement:
+    this->key("body");
+    this->_list(node.type == NodeType::Program ? static_cast<const Program&>(node).body
+      : static_cast<const BlockStatement&>(node).statements(), symbols, lines);
+    this->_loc(node, lines);
+    type();
+    break;
+
+  case NodeType::ExpressionStatement:
+    this->key("expression");
+    this->writeAst(*static_cast<const ExpressionStatement&>(node).expression, symbols, lines);
+    this->_loc(node, lines);
+    type();
+    break;
+
+  case NodeType::EmptyStatement:
+    this->_loc(node, lines);
+    type();
+    break;
+
+  case NodeType::AssignmentExpression:
+    this->_operation(static_cast<const AssignmentExpression&>(node), symbols, lines);
+    break;
+
+  case NodeType::BinaryExpression:
+    this->_operation(static_cast<const BinaryExpression&>(node), symbols, lines);
+    break;
+
+  case NodeType::Identifier:
+    this->_loc(node, lines);
+    this->key("name");
+    this->value(symbols.name(static_cast<const Identifier&>(node).name));
+    type();
+    break;
+
+  case NodeType::NumericLiteral: {
+    auto&& value = static_cast<const NumericLiteral&>(node).value;
+    this->_loc(node, lines);
+    type();
+    this->key("value");
+    if (value.isReal()) {
+      this->value(value.real);
+    } else {
+      this->value(value.integer);
+    }
+    break;
+  }
+
+  case NodeType::StringLiteral:
+    this->_loc(node, lines);
+    type();
+    this->key("value");
+    this->value(symbols.name(static_cast<const StringLiteral&>(node).value));
+    break;
+  }
+  this->endObject();
+}
+
+} // namespace letter
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Ast.h"
+#include "SourceLocation.h"
+#include "SymbolTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace letter {
+
+/**
+ * @brief: streaming json writer, writes through a fixed-size buffer flushed to a file descriptor or a std::ostream
+ * Memory does not grow with the output, only with the nesting depth. The output is byte-identical to
+ * `json::value::to_string()` in compact mode, and to `json::value::format()` in pretty mode.
+ * Keys are written in the order given, the caller gives them in the order of a json::object (sorted).
+ * Not copyable, the buffer is flushed on destruction, where errors are swallowed: call `flush` to see them.
+ */
+class JsonWriter {
+private:
+  std::unique_ptr<char[]> m_buffer;
+  std::size_t m_capacity;
+  std::size_t m_size;
+  int m_fd;                   // -1 when writing to `m_stream`
+  std::ostream* m_stream;
+  bool m_pretty;
+  uint64_t m_written;         // bytes flushed so far
+  std::vector<bool> m_empty;  // per open object or array, nothing written in it yet
+  bool m_after_key;
+
+public:
+  static constexpr std::size_t kBufferSize = 64 * 1024;
+
+  explicit JsonWriter(int fd, bool pretty = false, std::size_t buffer_size = kBufferSize);
+  explicit JsonWriter(std::ostream& stream, bool pretty = false, std::size_t buffer_size = kBufferSize);
+  ~JsonWriter();
+
+  JsonWriter(const JsonWriter&) = delete;
+  JsonWriter& operator=(const JsonWriter&) = delete;
+
+  void beginObject();
+  void endObject();
+  void beginArray();
+  void endArray();
+
+  /**
+   * @brief: the key of the next value, inside an object
+   */
+  void key(std::string_view name);
+
+  void value(std::string_view string);
+  void value(int64_t integer);
+  void value(double real);
+
+  /**
+   * @brief: write `node` in the json shape of `ast::toJson`, with "loc" if `lines` is given
+   */
+  void writeAst(const ast::Node& node, const SymbolTable& symbols, const LineIndex* lines = nullptr);
+
+  /**
+   * @brief: write out the buffer
+   * throw `letter::Exception` if the file descriptor or the stream fails
+   */
+  void flush();
+
+  /**
+   * @brief: bytes written so far, flushed or not
+   */
+  inline uint64_t written() const { return this->m_written + this->m_size; }
+
+private:
+  void _put(const char* data, std::size_t size);
+  inline void _put(char c) {
+    if (this->m_size == this->m_capacity) {
+      this->flush();
+    }
+    this->m_buffer[this->m_size++] = c;
+  }
+  void _indent(std::size_t depth);
+  void _beforeValue();
+  void _string(std::string_view string);
+  void _list(const ast::NodeList<ast::Statement>& list, const SymbolTable& symbols, const LineIndex* lines);
+  void _position(SourcePosition position);
+  void _loc(const ast::Node& node, const LineIndex* lines);
+  template <typename E>
+  void _operation(const E& e, const SymbolTable& symbols, const LineIndex* lines);
+};
+
+} // namespace letter
@@ -0,0 +1,38 @@
+#include "Number.h"
+
+#include <charconv>
+#include <system_error>
+
+namespace letter {
+
+NumberValue parseNumber(std::string_view text) {
+  const char* first = text.data();
+  const char* last = first + text.size();
+
+  NumberValue number;
+  if (text.size() > 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X')) {
+    auto&& [end, error] = std::from_chars(first + 2, last, number.integer, 16);
+    if (error != std::errc() || end != last) {
+      number.kind = NumberValue::Kind::OutOfRange;
+    }
+    return number;
+  }
+
+  // the digits before a fraction or an exponent stop the integer, the whole text is then a double
+  auto&& [end, error] = std::from_chars(first, last, number.integer);
+  if (end == last) {
+    if (error != std::errc()) {
+      number.kind = NumberValue::Kind::OutOfRange;
+    }
+    return number;
+  }
+
+  number.kind = NumberValue::Kind::Real;
+  auto&& [real_end, real_error] = std::from_chars(first, last, number.real);
+  if (real_error != std::errc() || real_end != last) {
+    number.kind = NumberValue::Kind::OutOfRange;
+  }
+  return number;
+}
+
+} // namespace letter
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace letter {
+
+/**
+ * @brief: value of a numeric literal, converted once from its text by the tokenizer
+ * Decimal and hex literals are integers, a literal with a fraction or an exponent is a double.
+ */
+struct NumberValue {
+  enum class Kind : uint8_t {
+    Integer,      // `integer` holds the value
+    Real,         // `real` holds the value
+    OutOfRange,   // does not fit an int64_t, or a double, the parser reports it
+  };
+
+  Kind kind = Kind::Integer;
+  union {
+    int64_t integer = 0;
+    double real;
+  };
+
+  NumberValue() = default;
+  explicit NumberValue(int64_t v) : kind(Kind::Integer), integer(v) {}
+  explicit NumberValue(double v) : kind(Kind::Real), real(v) {}
+
+  inline bool isReal() const { return this->kind == Kind::Real; }
+
+  /**
+   * @brief: the value as the interpreter computes with it
+   */
+  inline double toDouble() const { return this->isReal() ? this->real : static_cast<double>(this->integer); }
+};
+
+/**
+ * @brief: convert the text of a NUMBER token with `std::from_chars`, without allocating
+ * "0x" or "0X" then hex digits, or decimal digits with an optional fraction and exponent,
+ * as `Tokenizer` recognizes them.
+ */
+NumberValue parseNumber(std::string_view text);
+
+} // namespace letter
@@ -0,0 +1,139 @@
+#include "Optimizer.h"
+#include "Profiler.h"
+#include "Value.h"
+
+#include <cmath>
+#include <optional>
+
+namespace letter {
+
+namespace {
+
+struct _Optimizer {
+  Arena& arena;
+  SymbolTable& symbols;
+  OptimizeStats stats;
+
+  /**
+   * @brief: optimize a statement list, compacting the kept statements at its front
+   */
+  void optimizeList(ast::NodeList<ast::Statement>& list) {
+    uint32_t kept = 0;
+    for (auto* statement : list) {
+      if (this->optimizeStatement(statement)) {
+        list.data[kept++] = statement;
+      } else {
+        ++ this->stats.removed_statements;
+        this->stats.removed_nodes += ast::countNodes(*statement);
+      }
+    }
+    list.size = kept;
+  }
+
+  /**
+   * @return: false if `statement` does nothing and can be dropped
+   */
+  bool optimizeStatement(ast::Statement* statement) {
+    switch (statement->type) {
+    case ast::NodeType::EmptyStatement:
+      return false;
+    case ast::NodeType::BlockStatement: {
+      auto* block = static_cast<ast::BlockStatement*>(statement);
+      this->optimizeList(block->statements());
+      return !block->body.empty();
+    }
+    case ast::NodeType::ExpressionStatement: {
+      auto* e = static_cast<ast::ExpressionStatement*>(statement);
+      e->expression = this->optimizeExpression(e->expression);
+      return true;
+    }
+    default:
+      return true;
+    }
+  }
+
+  ast::Expression* optimizeExpression(ast::Expression* expression) {
+    if (auto* assignment = ast::cast<ast::AssignmentExpression>(expression)) {
+      assignment->right = this->optimizeExpression(assignment->right);
+      if (assignment->op != ast::Operator::Assign) {
+        // the target is always an Identifier, reading it again has no side effect
+        auto* target = static_cast<ast::Identifier*>(assignment->left);
+        auto* read = this->arena.make<ast::Identifier>(target->name);
+        read->slot = target->slot;
+        read->span = target->span;
+        assignment->right = this->arena.make<ast::BinaryExpression>(
+            arithmeticOperator(assignment->op), read, assignment->right);
+        assignment->right->span = assignment->span;
+        assignment->op = ast::Operator::Assign;
+        ++ this->stats.lowered_assignments;
+        this->stats.added_nodes += 2;
+      }
+      return assignment;
+    }
+
+    if (auto* binary = ast::cast<ast::BinaryExpression>(expression)) {
+      binary->left = this->optimizeExpression(binary->left);
+      binary->right = this->optimizeExpression(binary->right);
+      if (auto* folded = this->fold(binary)) {
+        folded->span = binary->span;
+        ++ this->stats.folded_expressions;
+        this->stats.removed_nodes += 2;
+        return folded;
+      }
+      return binary;
+    }
+
+    return expression;
+  }
+
+  std::optional<Value> literalValue(const ast::Expression* expression) const {
+    if (auto* number = ast::cast<const ast::NumericLiteral>(expression)) {
+      return Value(number->value.toDouble());
+    } else if (auto* string = ast::cast<const ast::StringLiteral>(expression)) {
+      return Value(this->symbols.name(string->value));
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * @return: the literal `binary` evaluates to, nullptr if it cannot be folded
+   */
+  ast::Expression* fold(const ast::BinaryExpression* binary) {
+    auto&& left = this->literalValue(binary->left);
+    auto&& right = this->literalValue(binary->right);
+    if (!left || !right) {
+      return nullptr;
+    }
+    // strings only take `+`, the other operators throw: keep the error for run time
+    if (binary->op != ast::Operator::Add && (left->isString() || right->isString())) {
+      return nullptr;
+    }
+
+    auto&& result = binaryOperation(binary->op, *left, *right);
+    if (result.isString()) {
+      return this->arena.make<ast::StringLiteral>(this->symbols.intern(result.asString()));
+    }
+
+    // only what a literal holds: no infinity or NaN, and no -0 either, 1 / -0 differs from 1 / 0
+    double number = result.asNumber();
+    if (!std::isfinite(number) || (number == 0 && std::signbit(number))) {
+      return nullptr;
+    }
+    // an integral result is the integer a literal of it would be
+    if (number == std::trunc(number) && number >= -0x1p63 && number < 0x1p63) {
+      return this->arena.make<ast::NumericLiteral>(NumberValue(static_cast<int64_t>(number)));
+    }
+    return this->arena.make<ast::NumericLiteral>(NumberValue(number));
+  }
+};
+
+} // namespace
+
+OptimizeStats optimize(ast::Program& program, Arena& arena, SymbolTable& symbols) {
+  LETTER_PROFILE_ZONE("optimize");
+  _Optimizer optimizer{arena, symbols, {}};
+  optimizer.optimizeList(program.body);
+  return optimizer.stats;
+}
+
+} // namespace letter
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Arena.h"
+#include "Ast.h"
+#include "SymbolTable.h"
+
+#include <cstddef>
+
+namespace letter {
+
+/**
+ * @brief: what one `optimize` run changed
+ */
+struct OptimizeStats {
+  std::size_t folded_expressions = 0;   // BinaryExpressions replaced by their literal value
+  std::size_t lowered_assignments = 0;  // `x op= e` rewritten as `x = x op e`
+  std::size_t removed_statements = 0;   // EmptyStatements and empty BlockStatements dropped
+  std::size_t removed_nodes = 0;        // nodes no longer in the tree, children included
+  std::size_t added_nodes = 0;          // nodes created by lowering
+
+  inline bool changed() const {
+    return this->folded_expressions + this->lowered_assignments + this->removed_statements != 0;
+  }
+};
+
+/**
+ * @brief: opt-in simplification of a parsed program, in place
+ * - BinaryExpressions whose operands are literals are folded into one literal,
+ *   `+` on strings included, fractions included. An operation that would throw, or whose
+ *   result no NumericLiteral holds (an infinity, a NaN, -0), is left for run time.
+ * - EmptyStatements are removed, and so are BlockStatements left with no statement.
+ * - compound assignments are lowered, `x += e` becomes `x = x + e`.
+ * The program evaluates to the same completion value and throws the same errors.
+ * New nodes come from `arena` and new strings are interned into `symbols`,
+ * which must be the ones of the parse. Running it twice changes nothing the second time.
+ */
+OptimizeStats optimize(ast::Program& program, Arena& arena, SymbolTable& symbols);
+
+} // namespace letter
@@ -0,0 +1,124 @@
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace letter {
+
+unsigned hardwareThreads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+namespace {
+
+/**
+ * @brief: indices [begin, end) left to a worker, its owner pops the front, thieves split the back
+ */
+struct alignas(64) _Share {
+  std::mutex mutex;
+  std::size_t begin = 0;
+  std::size_t end = 0;
+};
+
+struct _Scheduler {
+  std::vector<_Share> shares;
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  explicit _Scheduler(std::size_t workers) : shares(workers) {}
+
+  bool pop(unsigned worker, std::size_t& index) {
+    auto& share = this->shares[worker];
+    std::lock_guard<std::mutex> lock(share.mutex);
+    if (share.begin == share.end) {
+      return false;
+    }
+    index = share.begin++;
+    return true;
+  }
+
+  /**
+   * @brief: move the back half of the first non-empty share into the one of `worker`
+   */
+  bool steal(unsigned worker) {
+    const std::size_t n = this->shares.size();
+    for (std::size_t i = 1; i < n; ++i) {
+      auto& victim = this->shares[(worker + i) % n];
+      std::size_t begin, end;
+      {
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        const std::size_t left = victim.end - victim.begin;
+        if (left == 0) {
+          continue;
+        }
+        end = victim.end;
+        begin = victim.end - (left + 1) / 2;
+        victim.end = begin;
+      }
+      auto& share = this->shares[worker];
+      std::lock_guard<std::mutex> lock(share.mutex);
+      share.begin = begin;
+      share.end = end;
+      return true;
+    }
+    // all empty: the worker may exit while a stolen range is still in transit to another share,
+    // the thief finishes that range itself, so every index is still run before `parallelFor` returns
+    return false;
+  }
+
+  void work(unsigned worker, const std::function<void(std::size_t, unsigned)>& task) {
+    std::size_t index;
+    while (!this->failed.load(std::memory_order_relaxed)) {
+      if (!this->pop(worker, index) && !(this->steal(worker) && this->pop(worker, index))) {
+        return;
+      }
+      try {
+        task(index, worker);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(this->error_mutex);
+        if (!this->error) {
+          this->error = std::current_exception();
+        }
+        this->failed.store(true, std::memory_order_relaxed);
+      }
+    }
+  }
+};
+
+} // namespace
+
+void parallelFor(std::size_t count, unsigned threads, 
+    const std::function<void(std::size_t index, unsigned worker)>& task) {
+  if (threads == 0) {
+    threads = hardwareThreads();
+  }
+  const std::size_t workers = std::max<std::size_t>(1, std::min<std::size_t>(threads, count));
+
+  _Scheduler scheduler(workers);
+  for (std::size_t w = 0; w < workers; ++w) {
+    scheduler.shares[w].begin = count * w / workers;
+    scheduler.shares[w].end = count * (w + 1) / workers;
+  }
+
+  std::vector<std::thread> pool;
+  pool.reserve(workers - 1);
+  for (unsigned w = 1; w < workers; ++w) {
+    pool.emplace_back([&scheduler, &task, w]() { scheduler.work(w, task); });
+  }
+  scheduler.work(0, task);
+  for (auto&& thread : pool) {
+    thread.join();
+  }
+
+  if (scheduler.error) {
+    std::rethrow_exception(scheduler.error);
+  }
+}
+
+} // namespace letter
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace letter {
+
+/**
+ * @brief: number of hardware threads, at least 1
+ */
+unsigned hardwareThreads();
+
+/**
+ * @brief: call `task(index, worker)` for every index in [0, count), on `threads` workers
+ * Each worker starts on an equal contiguous share of the indices, taken from the front.
+ * A worker out of work steals the back half of the share of another one, so uneven
+ * tasks still keep every worker busy. The caller is worker 0, `threads` 0 means
+ * `hardwareThreads()`, and there are never more workers than indices.
+ * Returns once every task is done. If tasks throw, the remaining ones are skipped and
+ * the first exception is rethrown.
+ */
+void parallelFor(std::size_t count, unsigned threads, 
+    const std::function<void(std::size_t index, unsigned worker)>& task);
+
+} // namespace letter
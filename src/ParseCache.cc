@@ -0,0 +1,67 @@
+#include "ParseCache.h"
+#include "BinaryAst.h"
+#include "SourceBuffer.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <system_error>
+
+namespace letter {
+
+ParseCache::ParseCache(std::string directory) : m_directory(std::move(directory)) {
+  std::error_code error;
+  std::filesystem::create_directories(this->m_directory, error);
+}
+
+std::string ParseCache::entryPath(uint64_t hash) const {
+  char name[48];
+  std::snprintf(name, sizeof(name), "%016llx-v%u.ast", static_cast<unsigned long long>(hash), kBinaryAstVersion);
+  return (std::filesystem::path(this->m_directory) / name).string();
+}
+
+ast::Program* ParseCache::load(std::string_view source, uint64_t hash, Arena& arena, SymbolTable& symbols) const {
+  std::error_code error;
+  const std::string path = this->entryPath(hash);
+  if (!std::filesystem::is_regular_file(path, error)) {
+    return nullptr;
+  }
+
+  try {
+    // decoded straight from the mapping of the entry
+    auto&& entry = SourceBuffer::fromFile(path);
+    BinaryAstView view(entry.view());
+    if (view.header().source_hash != hash || view.header().source_size != source.size()) {
+      return nullptr;
+    }
+    return view.decode(arena, symbols);
+  } catch (const std::exception&) {
+    arena.reset();
+    symbols.clear();
+    return nullptr;
+  }
+}
+
+bool ParseCache::store(std::string_view source, uint64_t hash, const ast::Program& program, const SymbolTable& symbols) const {
+  const std::string path = this->entryPath(hash);
+  // unique, so that parsers storing the same entry at once do not write into each other
+  const std::string temporary = path + "." + std::to_string(std::random_device()()) + ".tmp";
+  {
+    auto&& bytes = encodeBinaryAst(program, symbols, hash, source.size());
+    std::ofstream ofs(temporary, std::ios::binary | std::ios::trunc);
+    if (!ofs.write(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporary, path, error);
+  if (error) {
+    std::filesystem::remove(temporary, error);
+    return false;
+  }
+  return true;
+}
+
+} // namespace letter
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Arena.h"
+#include "Ast.h"
+#include "SymbolTable.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace letter {
+
+/**
+ * @brief: directory of Binary AST files, one per parsed source, see `BinaryAst.h`
+ * An entry is named after the hash of the source and the format version, and its header
+ * records the hash and the size of the source again, so a changed source or an older
+ * format is never loaded. A missing, stale or damaged entry is just a miss.
+ */
+class ParseCache {
+private:
+  std::string m_directory;
+
+public:
+  /**
+   * @brief: keep the entries in `directory`, created if it does not exist
+   */
+  explicit ParseCache(std::string directory);
+
+  inline const std::string& directory() const { return this->m_directory; }
+
+  /**
+   * @brief: path of the entry of a source whose `hashSource` is `hash`
+   */
+  std::string entryPath(uint64_t hash) const;
+
+  /**
+   * @brief: the tree of `source` decoded from its entry into `arena` and `symbols`, nullptr on a miss
+   */
+  ast::Program* load(std::string_view source, uint64_t hash, Arena& arena, SymbolTable& symbols) const;
+
+  /**
+   * @brief: write the entry of `source`, false if it could not be written
+   * The entry is written aside then renamed, readers never see half of it.
+   */
+  bool store(std::string_view source, uint64_t hash, const ast::Program& program, const SymbolTable& symbols) const;
+};
+
+} // namespace letter
@@ -0,0 +1,26 @@
+#include "ParseContext.h"
+#include "Profiler.h"
+
+namespace letter {
+
+ParseContext::ParseContext() : m_parses(0) {
+
+}
+
+ast::Program* ParseContext::parse(std::string_view source) {
+  LETTER_PROFILE_ZONE("ParseContext::parse");
+  ++ this->m_parses;
+  return this->m_parser.parseAstReusing(source);
+}
+
+ast::Program* ParseContext::parse(std::string_view source, Diagnostics& diagnostics) {
+  LETTER_PROFILE_ZONE("ParseContext::parse(diagnostics)");
+  ++ this->m_parses;
+  return this->m_parser.parseAstReusing(source, diagnostics);
+}
+
+void ParseContext::reset() {
+  this->m_parser.clear();
+}
+
+} // namespace letter
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Ast.h"
+#include "Diagnostic.h"
+#include "Parser.h"
+#include "SymbolTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace letter {
+
+/**
+ * @brief: a parser kept warm for high rates of small sources, such as one-line expressions
+ * Everything a parse needs is kept from one parse to the next with its capacity: the copy of the
+ * source, the arena of the tree, the symbols, the scratch stacks and the tokenizer. Once they have
+ * grown to the size of the sources, a parse does not allocate at all. A syntax error thrown does,
+ * a syntax error recorded into preallocated `Diagnostics` does not.
+ * The tree of a parse is valid until the next `parse` or `reset`; its json form allocates, a
+ * `JsonWriter` writes it without. Parses are serial and from scratch: no cache, no incremental
+ * state, no locations and no lazy bodies. One context per thread.
+ */
+class ParseContext {
+private:
+  Parser m_parser;
+  uint64_t m_parses;  // since construction
+
+public:
+  ParseContext();
+
+  ParseContext(const ParseContext&) = delete;
+  ParseContext& operator=(const ParseContext&) = delete;
+
+  /**
+   * @brief: parse a copy of `source`
+   * throw `letter::Exception` on a syntax error, the context stays usable
+   */
+  ast::Program* parse(std::string_view source);
+
+  /**
+   * @brief: parse a copy of `source`, record syntax errors into `diagnostics`, see `Parser::parse`
+   */
+  ast::Program* parse(std::string_view source, Diagnostics& diagnostics);
+
+  /**
+   * @brief: drop the tree and the source of the last parse, keep the memory for the next one
+   */
+  void reset();
+
+  inline const SymbolTable& symbols() const { return this->m_parser.symbols(); }
+
+  inline std::string_view source() const { return this->m_parser.source(); }
+
+  inline std::string diagnosticMessage(const Diagnostic& diagnostic) const {
+    return this->m_parser.diagnosticMessage(diagnostic);
+  }
+
+  inline uint64_t parses() const { return this->m_parses; }
+
+  /**
+   * @brief: arena memory held for the trees of the next parses
+   */
+  inline std::size_t bytesReserved() const { return this->m_parser.arena().bytesReserved(); }
+};
+
+} // namespace letter
@@ -0,0 +1,50 @@
+#include "ParseMany.h"
+#include "Parallel.h"
+#include "Parser.h"
+
+#include <exception>
+#include <memory>
+
+namespace letter {
+
+/**
+ * @brief: run `parse(parser, index)` for every input, with one parser per worker,
+ * and move each tree out of the parser into its result
+ */
+template <typename Parse>
+static std::vector<ParseResult> _parseMany(std::size_t count, unsigned threads, Parse&& parse) {
+  std::vector<ParseResult> results(count);
+  std::vector<std::unique_ptr<Parser>> parsers(threads == 0 ? hardwareThreads() : threads);
+
+  parallelFor(count, threads, [&](std::size_t index, unsigned worker) {
+    auto& parser = parsers[worker];
+    if (!parser) {
+      parser = std::make_unique<Parser>();
+    }
+
+    auto& result = results[index];
+    try {
+      result.program = parse(*parser, index);
+      parser->release(result.arena, result.symbols);
+    } catch (const std::exception& e) {
+      result.program = nullptr;
+      result.error = e.what();
+    }
+  });
+
+  return results;
+}
+
+std::vector<ParseResult> parseMany(const std::vector<std::string>& paths, unsigned threads) {
+  return _parseMany(paths.size(), threads, [&](Parser& parser, std::size_t index) {
+    return parser.parseFileAst(paths[index]);
+  });
+}
+
+std::vector<ParseResult> parseMany(const std::vector<std::string_view>& sources, unsigned threads) {
+  return _parseMany(sources.size(), threads, [&](Parser& parser, std::size_t index) {
+    return parser.parseAst(std::string(sources[index]));
+  });
+}
+
+} // namespace letter
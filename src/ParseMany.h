@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Arena.h"
+#include "Ast.h"
+#include "SymbolTable.h"
+#include "json.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace letter {
+
+/**
+ * @brief: outcome of one input of `parseMany`
+ * The tree lives in the arena and the symbol table of the result,
+ * it stays valid as long as the result does.
+ */
+struct ParseResult {
+  Arena arena;
+  SymbolTable symbols;
+  ast::Program* program = nullptr;  // nullptr if the input failed
+  std::string error;                // what the input failed with, a syntax or a read error
+
+  inline bool ok() const { return this->program != nullptr; }
+
+  /**
+   * @brief: the json form of the tree, as `Parser::parse` returns it
+   */
+  inline json::value toJson() const { return ast::toJson(*this->program, this->symbols); }
+};
+
+/**
+ * @brief: parse the files at `paths` on a work-stealing pool of `threads` workers
+ * Every worker parses with its own `Parser`, files are read as `Parser::parseFileAst` does.
+ * `threads` 0 means one per hardware thread.
+ * @return: one result per path, in the order of `paths`; a failed file does not stop the others
+ */
+std::vector<ParseResult> parseMany(const std::vector<std::string>& paths, unsigned threads = 0);
+
+/**
+ * @brief: same, on sources already in memory, which must outlive the call
+ */
+std::vector<ParseResult> parseMany(const std::vector<std::string_view>& sources, unsigned threads = 0);
+
+} // namespace letter
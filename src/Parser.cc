@@ -1,5 +1,8 @@
 #include "Parser.h"
+#include "BinaryAst.h"
 #include "Exception.h"
+#include "Parallel.h"
+#include "Profiler.h"
 #include "json.hpp"
 
 #include <optional>
@@ -7,27 +10,669 @@
 #include <system_error>
 #include <cassert>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <utility>
 
 namespace letter {
 
 Parser::Parser() 
-  : m_string(), m_tokenizer(std::make_unique<Tokenizer>()) {
+  : m_source(), m_tokenizer(std::make_unique<Tokenizer>()), m_incremental(false),
+    m_last_end(0), m_node_count(0), m_full_parse_bytes(0), m_threads(1), m_parallel_size(kParallelSize),
+    m_part_count(0), m_cache_hit(false),
+    m_diagnostics(nullptr), m_panic(false), m_locations(false), m_lines_built(false),
+    m_lazy_blocks(false), m_lazy_program(nullptr) {
+  this->m_tokenizer->setSymbolTable(&this->m_symbols);
 
 }
 
 json::value Parser::parse(const std::string &str) {
-  this->m_string = str;
-  this->m_tokenizer->init(str);
+  auto* program = this->parseAst(str);
+  if (this->m_lazy_program) {
+    this->validate(*program);
+  }
+  return ast::toJson(*program, this->m_symbols, this->_jsonLines());
+}
+
+json::value Parser::parseFile(const std::string &path) {
+  auto* program = this->parseFileAst(path);
+  if (this->m_lazy_program) {
+    this->validate(*program);
+  }
+  return ast::toJson(*program, this->m_symbols, this->_jsonLines());
+}
+
+ast::Program* Parser::parseAst(const std::string &str) {
+  instrument::PhaseScope phase(instrument::Phase::Parse);
+  LETTER_PROFILE_ZONE("Parser::parseAst");
+  // the only copy of the source, the tokenizer views it
+  this->m_source = SourceBuffer::fromString(str);
+  return this->_parseSource();
+}
+
+ast::Program* Parser::parseFileAst(const std::string &path) {
+  instrument::PhaseScope phase(instrument::Phase::Parse);
+  LETTER_PROFILE_ZONE("Parser::parseFileAst");
+  this->m_source = SourceBuffer::fromFile(path);
+  return this->_parseSource();
+}
+
+ast::Program* Parser::parseAstReusing(std::string_view text) {
+  instrument::PhaseScope phase(instrument::Phase::Parse);
+  LETTER_PROFILE_ZONE("Parser::parseAstReusing");
+  this->m_source.assign(text);
+  return this->_parseSource();
+}
+
+json::value Parser::parse(const std::string &str, Diagnostics& diagnostics) {
+  auto* program = this->parseAst(str, diagnostics);
+  return ast::toJson(*program, this->m_symbols, this->_jsonLines());
+}
+
+ast::Program* Parser::parseAst(const std::string &str, Diagnostics& diagnostics) {
+  instrument::PhaseScope phase(instrument::Phase::Parse);
+  LETTER_PROFILE_ZONE("Parser::parseAst(diagnostics)");
+  this->m_source = SourceBuffer::fromString(str);
+  return this->_parseDiagnosing(diagnostics);
+}
+
+ast::Program* Parser::parseFileAst(const std::string &path, Diagnostics& diagnostics) {
+  instrument::PhaseScope phase(instrument::Phase::Parse);
+  LETTER_PROFILE_ZONE("Parser::parseFileAst(diagnostics)");
+  this->m_source = SourceBuffer::fromFile(path);
+  return this->_parseDiagnosing(diagnostics);
+}
+
+ast::Program* Parser::parseAstReusing(std::string_view text, Diagnostics& diagnostics) {
+  instrument::PhaseScope phase(instrument::Phase::Parse);
+  LETTER_PROFILE_ZONE("Parser::parseAstReusing(diagnostics)");
+  this->m_source.assign(text);
+  return this->_parseDiagnosing(diagnostics);
+}
+
+json::value Parser::reparse(const TextEdit& edit) {
+  auto* program = this->reparseAst(edit);
+  return ast::toJson(*program, this->m_symbols, this->_jsonLines());
+}
+
+ast::Program* Parser::reparseAst(const TextEdit& edit) {
+  instrument::PhaseScope phase(instrument::Phase::Parse);
+  LETTER_PROFILE_ZONE("Parser::reparseAst");
+  auto&& old = this->m_source.view();
+  if (edit.offset > old.size() || edit.removed > old.size() - edit.offset) {
+    throw Exception("Edit out of the source: offset " + std::to_string(edit.offset) + 
+        ", removed " + std::to_string(edit.removed) + ", source size " + std::to_string(old.size()));
+  }
+
+  // nodes never view the source, only the tokens do
+  this->m_lookahead = Token{};
+  this->m_source.replace(edit.offset, edit.removed, edit.inserted);
+  this->m_lines_built = false;
+
+  // every reparse leaves the replaced nodes in the arena, start over once they outweigh the tree
+  if (!this->m_incremental || this->m_arena.bytesUsed() > 4 * this->m_full_parse_bytes + 64 * 1024) {
+    return this->_parseFromScratch();
+  }
+
+  this->_shiftSpans(edit);
+  this->m_reparse_stats = ReparseStats{};
+  this->m_reparse_stats.full = false;
+  return this->_parse();
+}
+
+void Parser::clear() {
+  this->m_lookahead = Token{};
+  this->m_source.assign({});
+  this->m_arena.reset();
+  this->m_part_count = 0;
+  this->m_lazy_program = nullptr;
+  this->m_symbols.clear();
+  this->m_top_spans.clear();
+  this->m_block_spans.clear();
+  this->m_program_body.clear();
+  this->m_lines_built = false;
+  this->m_cache_hit = false;
+  this->m_reparse_stats = ReparseStats{};
+}
+
+void Parser::release(Arena& arena, SymbolTable& symbols) {
+  assert(!this->m_incremental);
+  if (this->m_lazy_program) {
+    // lazy bodies are parsed by this parser from its source, which the next parse replaces
+    this->validate(*this->m_lazy_program);
+    this->m_lazy_program = nullptr;
+  }
+  arena = std::move(this->m_arena);
+  // the statements of a parallel parse are in the arenas of its parts
+  for (std::size_t i = 0; i < this->m_part_count; ++i) {
+    arena.adopt(std::move(this->m_parts[i].arena));
+  }
+  this->m_part_count = 0;
+  symbols = std::move(this->m_symbols);
+  this->m_symbols = SymbolTable();
+  this->m_top_spans.clear();
+  this->m_block_spans.clear();
+}
+
+const LineIndex& Parser::lineIndex() {
+  if (!this->m_lines_built) {
+    this->m_lines.build(this->m_source.view());
+    this->m_lines_built = true;
+  }
+  return this->m_lines;
+}
+
+void Parser::setCacheDirectory(const std::string& directory) {
+  this->m_cache = directory.empty() ? nullptr : std::make_unique<ParseCache>(directory);
+}
+
+/**
+ * @brief: parse `m_source`, or load its tree from the cache
+ */
+ast::Program* Parser::_parseSource() {
+  this->m_lines_built = false;
+  this->m_cache_hit = false;
+  if (!this->m_cache || this->m_incremental || this->m_locations || this->m_lazy_blocks) {
+    return this->_parseFromScratch();
+  }
+
+  auto&& text = this->m_source.view();
+  const uint64_t hash = hashSource(text);
+
+  this->m_arena.reset();
+  this->m_part_count = 0;
+  this->m_lazy_program = nullptr;
+  this->m_top_spans.clear();
+  this->m_block_spans.clear();
+  this->m_reparse_stats = ReparseStats{};
+  if (auto* program = this->m_cache->load(text, hash, this->m_arena, this->m_symbols)) {
+    this->m_cache_hit = true;
+    this->m_full_parse_bytes = this->m_arena.bytesUsed();
+    return program;
+  }
+
+  auto* program = this->_parseFromScratch();
+  this->m_cache->store(text, hash, *program, this->m_symbols);
+  return program;
+}
+
+ast::Program* Parser::_parseFromScratch() {
+  // drop the previous tree, nothing of it is reused
+  this->m_arena.reset();
+  this->m_part_count = 0;
+  this->m_lazy_program = nullptr;
+  this->m_symbols.clear();
+  this->m_top_spans.clear();
+  this->m_block_spans.clear();
+  this->m_reparse_stats = ReparseStats{};
+
+  ast::Program* program = nullptr;
+  if (!this->m_incremental && !this->m_diagnostics && !this->m_lazy_blocks && 
+      this->m_threads > 1 && this->m_source.view().size() >= this->m_parallel_size) {
+    program = this->_parseParallel();
+  }
+  if (!program) {
+    program = this->_parse();
+  }
+  this->m_lazy_program = this->m_lazy_blocks && !this->m_diagnostics ? program : nullptr;
+  this->m_full_parse_bytes = this->m_arena.bytesUsed();
+  return program;
+}
+
+ast::Program* Parser::_parseDiagnosing(Diagnostics& diagnostics) {
+  this->m_lines_built = false;
+  this->m_cache_hit = false;
+
+  diagnostics.clear();
+  this->m_diagnostics = &diagnostics;
+  this->m_tokenizer->setDiagnostics(&diagnostics);
+  this->m_panic = false;
+  const bool incremental = this->m_incremental;
+  this->m_incremental = false; // nothing to reuse in a tree with holes
+
+  auto* program = this->_parseFromScratch();
+
+  this->m_incremental = incremental;
+  this->m_diagnostics = nullptr;
+  this->m_tokenizer->setDiagnostics(nullptr);
+  return program;
+}
+
+ast::Program* Parser::_parse() {
+  this->m_statement_stack.clear();
+  this->m_new_top_spans.clear();
+  this->m_new_block_spans.clear();
+  this->m_node_count = 0;
+
+  this->m_text = this->m_source.view();
+  this->m_tokenizer->initView(this->m_text);
+  this->m_lookahead = this->m_tokenizer->getNextToken();
 
+  auto* program = this->Program();
+
+  if (this->m_incremental) {
+    // the spans of the previous tree that were not taken back stay valid, as long as their text is unchanged
+    this->m_top_spans.swap(this->m_new_top_spans);
+
+    auto&& blocks = this->m_block_spans;
+    const auto middle = blocks.insert(blocks.end(), this->m_new_block_spans.begin(), this->m_new_block_spans.end());
+    std::inplace_merge(blocks.begin(), middle, blocks.end(), 
+        [](const _Span& a, const _Span& b) { return a.start < b.start; });
+  }
+  this->m_reparse_stats.nodes = this->m_node_count;
+  return program;
+}
+
+/**
+ * @brief: parse a part of a source, for a parallel parse, into the arena and symbols as they are
+ */
+ast::Program* Parser::_parseView(std::string_view text) {
+  this->m_arena.reset();
+  this->m_symbols.clear();
+  this->m_statement_stack.clear();
+  this->m_node_count = 0;
+
+  this->m_text = text;
+  this->m_tokenizer->initView(text);
   this->m_lookahead = this->m_tokenizer->getNextToken();
   return this->Program();
 }
 
-json::value Parser::Program() {
-  return json::object{
-    {"type", "Program"},
-    {"body", this->StatementList()}
+/**
+ * @brief: rewrite the atoms of a subtree, `remap` is indexed by the old atom
+ */
+static void _remapAtoms(ast::Node* node, const std::vector<Atom>& remap) {
+  switch (node->type) {
+  case ast::NodeType::Program:
+    for (auto* statement : static_cast<ast::Program*>(node)->body) {
+      _remapAtoms(statement, remap);
+    }
+    break;
+  case ast::NodeType::BlockStatement:
+    for (auto* statement : static_cast<ast::BlockStatement*>(node)->body) {
+      _remapAtoms(statement, remap);
+    }
+    break;
+  case ast::NodeType::ExpressionStatement:
+    _remapAtoms(static_cast<ast::ExpressionStatement*>(node)->expression, remap);
+    break;
+  case ast::NodeType::AssignmentExpression: {
+    auto* e = static_cast<ast::AssignmentExpression*>(node);
+    _remapAtoms(e->left, remap);
+    _remapAtoms(e->right, remap);
+    break;
+  }
+  case ast::NodeType::BinaryExpression: {
+    auto* e = static_cast<ast::BinaryExpression*>(node);
+    _remapAtoms(e->left, remap);
+    _remapAtoms(e->right, remap);
+    break;
+  }
+  case ast::NodeType::Identifier: {
+    auto* identifier = static_cast<ast::Identifier*>(node);
+    identifier->name = remap[identifier->name];
+    break;
+  }
+  case ast::NodeType::StringLiteral: {
+    auto* string = static_cast<ast::StringLiteral*>(node);
+    string->value = remap[string->value];
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief: move the spans of a subtree by `delta` bytes
+ */
+static void _shiftLocations(ast::Node* node, int64_t delta) {
+  node->span.offset = static_cast<uint32_t>(node->span.offset + delta);
+  switch (node->type) {
+  case ast::NodeType::Program:
+    for (auto* statement : static_cast<ast::Program*>(node)->body) {
+      _shiftLocations(statement, delta);
+    }
+    break;
+  case ast::NodeType::BlockStatement:
+    for (auto* statement : static_cast<ast::BlockStatement*>(node)->body) {
+      _shiftLocations(statement, delta);
+    }
+    break;
+  case ast::NodeType::ExpressionStatement:
+    _shiftLocations(static_cast<ast::ExpressionStatement*>(node)->expression, delta);
+    break;
+  case ast::NodeType::AssignmentExpression: {
+    auto* e = static_cast<ast::AssignmentExpression*>(node);
+    _shiftLocations(e->left, delta);
+    _shiftLocations(e->right, delta);
+    break;
+  }
+  case ast::NodeType::BinaryExpression: {
+    auto* e = static_cast<ast::BinaryExpression*>(node);
+    _shiftLocations(e->left, delta);
+    _shiftLocations(e->right, delta);
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief: parse the parts of the source in parallel, and join them into one Program
+ * nullptr if the source can not be cut or a part fails
+ */
+ast::Program* Parser::_parseParallel() {
+  LETTER_PROFILE_ZONE("Parser::_parseParallel");
+  auto&& source = this->m_source.view();
+  this->m_text = source;
+  auto&& cuts = splitTopLevel(source, source.size() / (this->m_threads * 4));
+  if (cuts.empty()) {
+    return nullptr;
+  }
+
+  const std::size_t count = cuts.size() + 1;
+  this->m_parts.resize(count);
+  this->m_workers.resize(std::max<std::size_t>(this->m_workers.size(), this->m_threads));
+  std::vector<std::size_t> nodes(count);
+  std::atomic<bool> failed{false};
+
+  parallelFor(count, this->m_threads, [&](std::size_t index, unsigned worker_index) {
+    if (failed.load(std::memory_order_relaxed)) {
+      return;
+    }
+    auto& worker = this->m_workers[worker_index];
+    if (!worker) {
+      worker = std::make_unique<Parser>();
+    }
+    worker->m_locations = this->m_locations;
+
+    // every part keeps its arena and symbols from parse to parse, with their capacity
+    auto& part = this->m_parts[index];
+    worker->m_arena = std::move(part.arena);
+    worker->m_symbols = std::move(part.symbols);
+
+    const std::size_t begin = index == 0 ? 0 : cuts[index - 1];
+    const std::size_t end = index == cuts.size() ? source.size() : cuts[index];
+    try {
+      part.program = worker->_parseView(source.substr(begin, end - begin));
+      nodes[index] = worker->m_node_count - 1; // without the Program of the part
+    } catch (const std::exception& e) {
+      part.program = nullptr;
+      failed.store(true, std::memory_order_relaxed);
+    }
+
+    part.arena = std::move(worker->m_arena);
+    part.symbols = std::move(worker->m_symbols);
+  });
+
+  if (failed.load()) {
+    return nullptr; // the serial parse finds the error a serial parse reports
+  }
+
+  // interning the atoms of the parts in part order numbers them by first appearance, like a serial parse
+  std::vector<std::vector<Atom>> remaps(count);
+  std::size_t statements = 0;
+  this->m_node_count = 1;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto& part = this->m_parts[i];
+    auto& remap = remaps[i];
+    bool identity = true;
+    remap.resize(part.symbols.size());
+    for (Atom atom = 0; atom < remap.size(); ++atom) {
+      remap[atom] = this->m_symbols.intern(part.symbols.name(atom));
+      identity = identity && remap[atom] == atom;
+    }
+    if (identity) {
+      remap.clear();
+    }
+    statements += part.program->body.size;
+    this->m_node_count += nodes[i];
+  }
+
+  parallelFor(count, this->m_threads, [&](std::size_t index, unsigned) {
+    if (!remaps[index].empty()) {
+      _remapAtoms(this->m_parts[index].program, remaps[index]);
+    }
+    if (this->m_locations && index > 0) {
+      // the part was located in its own text
+      _shiftLocations(this->m_parts[index].program, static_cast<int64_t>(cuts[index - 1]));
+    }
+  });
+
+  ast::NodeList<ast::Statement> body;
+  body.size = static_cast<uint32_t>(statements);
+  body.data = this->m_arena.allocateArray<ast::Statement*>(statements);
+  auto* out = body.data;
+  for (auto&& part : this->m_parts) {
+    out = std::copy(part.program->body.begin(), part.program->body.end(), out);
+  }
+
+  this->m_reparse_stats.nodes = this->m_node_count;
+  this->m_part_count = count;
+  return this->_locateProgram(this->_make<ast::Program>(body));
+}
+
+/**
+ * @brief: move the spans of the previous tree to the edited text
+ * Spans before the edit stay, spans after it shift, spans touching it are dropped.
+ */
+void Parser::_shiftSpans(const TextEdit& edit) {
+  const std::size_t edit_end = edit.offset + edit.removed;
+  auto&& shift = [&](_Span& span) {
+    span.start = span.start + edit.inserted.size() - edit.removed;
+    span.end = span.end + edit.inserted.size() - edit.removed;
   };
+
+  // top-level spans are sorted by start and by end, only the ones after the edit move
+  auto&& top = this->m_top_spans;
+  auto first = std::partition_point(top.begin(), top.end(), 
+      [&](const _Span& span) { return span.end <= edit.offset; });
+  auto last = std::partition_point(first, top.end(), 
+      [&](const _Span& span) { return span.start < edit_end; });
+  if (first != top.begin() && first != top.end()) {
+    (first - 1)->linked = false; // the text or the statement that followed it changed
+  }
+  first = top.erase(first, last);
+  for (; first != top.end(); ++first) {
+    shift(*first);
+  }
+
+  // blocks nest, their ends are not sorted
+  std::size_t kept = 0;
+  for (auto span : this->m_block_spans) {
+    if (span.start >= edit_end) {
+      shift(span);
+    } else if (span.end > edit.offset) {
+      continue;
+    }
+    this->m_block_spans[kept++] = span;
+  }
+  this->m_block_spans.resize(kept);
+}
+
+/**
+ * @brief: if locating, move the spans of a statement taken back from the previous tree to where it starts now
+ * Only statements after an edit move, by the size change of the edit.
+ */
+void Parser::_moveReused(ast::Statement* statement, std::size_t start) {
+  if (this->m_locations && statement->span.offset != start) {
+    _shiftLocations(statement, static_cast<int64_t>(start) - statement->span.offset);
+  }
+}
+
+/**
+ * @brief: a lazy block for the "{" of the lookahead, its body skipped up to the matching "}"
+ * nullptr if the braces do not match, the block is parsed then, and fails as it does eagerly.
+ */
+ast::Statement* Parser::_lazyBlock() {
+  LETTER_PROFILE_ZONE("Parser::_lazyBlock");
+  const std::size_t start = this->_offsetOf(this->m_lookahead);
+  const std::size_t close = findBlockClose(this->m_text, start);
+  if (close == this->m_text.size()) {
+    return nullptr;
+  }
+
+  auto* lazy = this->m_arena.make<ast::LazyBody>(
+    ast::LazyBody{this, static_cast<uint32_t>(start + 1), static_cast<uint32_t>(close - start - 1), this->m_locations});
+
+  // the body is never tokenized, the lexer goes on after the "}"
+  this->m_tokenizer->seek(close + 1);
+  this->m_lookahead = this->m_tokenizer->getNextToken();
+  this->m_last_end = close + 1;
+  return this->_locate(this->_make<ast::BlockStatement>(ast::NodeList<ast::Statement>{}, lazy), start);
+}
+
+/**
+ * @brief: parse the body of a lazy block, from the source of the last parse
+ * The parse of the tree is over, the lexer and the lookahead are free.
+ */
+void Parser::parseBody(ast::BlockStatement& block) {
+  LETTER_PROFILE_ZONE("Parser::parseBody");
+  instrument::PhaseScope phase(instrument::Phase::Parse);
+  auto* lazy = block.lazy;
+  this->m_text = this->m_source.view();
+  this->m_tokenizer->initView(this->m_text);
+  this->m_tokenizer->seek(lazy->offset);
+  this->m_lookahead = this->m_tokenizer->getNextToken();
+
+  // with the settings of the parse which skipped the body, not the ones of now
+  const bool locations = this->m_locations;
+  const bool lazy_blocks = this->m_lazy_blocks;
+  this->m_locations = lazy->locations;
+  this->m_lazy_blocks = true;
+
+  const std::size_t base = this->m_statement_stack.size();
+  try {
+    auto&& body = this->m_lookahead.kind == TokenKind::RightBrace ? 
+      ast::NodeList<ast::Statement>{} : this->StatementList(TokenKind::RightBrace);
+    this->_eat(TokenKind::RightBrace);
+    block.body = body;
+    block.lazy = nullptr;
+  } catch (...) {
+    this->m_statement_stack.resize(base);
+    this->m_locations = locations;
+    this->m_lazy_blocks = lazy_blocks;
+    throw;
+  }
+  this->m_locations = locations;
+  this->m_lazy_blocks = lazy_blocks;
+}
+
+void Parser::validate(ast::Node& node) {
+  switch (node.type) {
+  case ast::NodeType::Program:
+    for (auto* statement : static_cast<ast::Program&>(node).body) {
+      this->validate(*statement);
+    }
+    break;
+  case ast::NodeType::BlockStatement:
+    for (auto* statement : static_cast<ast::BlockStatement&>(node).statements()) {
+      this->validate(*statement);
+    }
+    break;
+  default:
+    break; // no block under other nodes
+  }
+}
+
+/**
+ * @brief: take back the unchanged block starting at the lookahead, nullptr if there is none
+ */
+ast::Statement* Parser::_reuseBlock() {
+  const std::size_t start = this->_offsetOf(this->m_lookahead);
+  auto&& spans = this->m_block_spans;
+  auto it = std::lower_bound(spans.begin(), spans.end(), start, _Span::before);
+  if (it == spans.end() || it->start != start) {
+    return nullptr;
+  }
+
+  // the lexer state between two tokens is only the cursor
+  this->m_tokenizer->seek(it->end);
+  this->m_lookahead = this->m_tokenizer->getNextToken();
+  this->m_last_end = it->end;
+  this->_moveReused(it->statement, it->start);
+
+  this->m_node_count += it->nodes;
+  this->m_reparse_stats.reused_nodes += it->nodes;
+  ++ this->m_reparse_stats.reused_statements;
+  return it->statement;
+}
+
+/**
+ * @brief: move the statements pushed on the stack since `base` into an arena list
+ */
+ast::NodeList<ast::Statement> Parser::_takeStatements(std::size_t base) {
+  auto&& stack = this->m_statement_stack;
+
+  ast::NodeList<ast::Statement> statement_list;
+  statement_list.size = static_cast<uint32_t>(stack.size() - base);
+  statement_list.data = this->m_arena.allocateArray<ast::Statement*>(statement_list.size);
+  std::copy(stack.begin() + base, stack.end(), statement_list.data);
+  stack.resize(base);
+
+  return statement_list;
+}
+
+/**
+ * Program
+ *  : StatementList
+ *  ;
+ */
+ast::Program* Parser::Program() {
+  LETTER_PROFILE_ZONE("Parser::Program");
+  if (!this->m_incremental) {
+    return this->_locateProgram(this->_make<ast::Program>(this->StatementList()));
+  }
+
+  // the StatementList, recording where each statement lies,
+  // and taking back the runs of unchanged statements of the previous tree
+  auto&& body = this->m_program_body;
+  auto&& spans = this->m_top_spans;
+  body.clear();
+  do {
+    const std::size_t start = this->_offsetOf(this->m_lookahead);
+    auto it = std::lower_bound(spans.begin(), spans.end(), start, _Span::before);
+
+    if (it != spans.end() && it->start == start) {
+      // the run of statements parsed in a row last time, up to the first one followed by an edit
+      const std::size_t first = it - spans.begin();
+      std::size_t last = first;
+      std::size_t nodes = spans[first].nodes;
+      while (last + 1 < spans.size() && spans[last].linked) {
+        nodes += spans[++last].nodes;
+      }
+
+      const std::size_t count = last - first + 1;
+      body.reserve(body.size() + count);
+      for (std::size_t i = first; i <= last; ++i) {
+        body.push_back(spans[i].statement);
+        this->_moveReused(spans[i].statement, spans[i].start);
+      }
+      this->m_new_top_spans.insert(this->m_new_top_spans.end(), it, it + count);
+      this->m_new_top_spans.back().linked = true;
+
+      this->m_node_count += nodes;
+      this->m_reparse_stats.reused_nodes += nodes;
+      this->m_reparse_stats.reused_statements += count;
+
+      this->m_tokenizer->seek(spans[last].end);
+      this->m_lookahead = this->m_tokenizer->getNextToken();
+      this->m_last_end = spans[last].end;
+      continue;
+    }
+
+    const std::size_t nodes = this->m_node_count;
+    auto* statement = this->Statement();
+    body.push_back(statement);
+    this->m_new_top_spans.push_back({start, this->m_last_end, this->m_node_count - nodes, statement, true});
+  } while (!this->m_lookahead.empty());
+
+  ast::NodeList<ast::Statement> statement_list;
+  statement_list.data = body.data();
+  statement_list.size = static_cast<uint32_t>(body.size());
+  return this->_locateProgram(this->_make<ast::Program>(statement_list));
 }
 
 /**
@@ -35,16 +680,24 @@ json::value Parser::Program() {
  *  : Statement
  *  | StatementList Statement -> Statement Statement Statement Statement
  */
-json::value Parser::StatementList(const std::optional<std::string>& stop_lookahead_tokentype/*= std::nullopt*/) {
-  json::array statement_list;
+ast::NodeList<ast::Statement> Parser::StatementList(std::optional<TokenKind> stop_lookahead_tokenkind/*= std::nullopt*/) {
+  LETTER_PROFILE_ZONE("Parser::StatementList");
+  // nested lists push on top of the enclosing ones, then move their own part into the arena
+  auto&& stack = this->m_statement_stack;
+  const std::size_t base = stack.size();
 
-  statement_list.emplace_back(this->Statement());
-  while (!this->m_lookahead.empty() && this->m_lookahead["type"] != stop_lookahead_tokentype.value_or("_null")) {
-    // stop_lookahead_tokentype 是指结束查找语句的标识，如块语句从'{'查找到下一个'}'为止
-    statement_list.emplace_back(this->Statement());
-  } 
+  // stop_lookahead_tokenkind 是指结束查找语句的标识，如块语句从'{'查找到下一个'}'为止
+  do {
+    auto* statement = this->Statement();
+    if (this->m_panic) {
+      // diagnostics mode: drop the statement with the error, and go on with the next one
+      this->_synchronize(stop_lookahead_tokenkind == TokenKind::RightBrace);
+      continue;
+    }
+    stack.push_back(statement);
+  } while (!this->m_lookahead.empty() && this->m_lookahead.kind != stop_lookahead_tokenkind);
 
-  return statement_list; // a json::array, no "type" property
+  return this->_takeStatements(base); // no "type" property
 }
 
 /**
@@ -54,13 +707,23 @@ json::value Parser::StatementList(const std::optional<std::string>& stop_lookahe
  *  | EmptyStatement
  *  ;
  */
-json::value Parser::Statement() {
+ast::Statement* Parser::Statement() {
+  LETTER_PROFILE_ZONE("Parser::Statement");
   assert(!this->m_lookahead.empty());
 
-  auto&& type = this->m_lookahead["type"].as_string();
-  if (type == "{") {
+  auto kind = this->m_lookahead.kind;
+  if (kind == TokenKind::LeftBrace) {
+    if (this->m_incremental) {
+      if (auto* block = this->_reuseBlock()) {
+        return block;
+      }
+    } else if (this->m_lazy_blocks && !this->m_diagnostics) {
+      if (auto* block = this->_lazyBlock()) {
+        return block;
+      }
+    }
     return this->BlockStatement();
-  } else if (type == ";") {
+  } else if (kind == TokenKind::Semicolon) {
     return this->EmptyStatement();
   } else {
     return this->ExpressionStatement();
@@ -72,14 +735,13 @@ json::value Parser::Statement() {
  *  : Expression ";"
  *  ;
  */
-json::value Parser::ExpressionStatement() {
-  auto&& expression = this->Expression();
-  this->_eat(";");
+ast::Statement* Parser::ExpressionStatement() {
+  LETTER_PROFILE_ZONE("Parser::ExpressionStatement");
+  const std::size_t start = this->_offsetOf(this->m_lookahead);
+  auto* expression = this->Expression();
+  this->_eat(TokenKind::Semicolon);
 
-  return json::object{
-    {"type", "ExpressionStatement"},
-    {"expression", expression}
-  };
+  return this->_locate(this->_make<ast::ExpressionStatement>(expression), start);
 }
 
 /**
@@ -87,24 +749,37 @@ json::value Parser::ExpressionStatement() {
  *  : "{" OptStatementList "}" (Opt means optional)
  *  ;
  */
-json::value Parser::BlockStatement() {
-  this->_eat("{");
-  
-  // if is an empty block, return an empty json::array, which in json is []
-  auto&& body = this->m_lookahead["type"].as_string() == "}" ? 
-    json::value{json::array{}} : this->StatementList("}");
+ast::Statement* Parser::BlockStatement() {
+  LETTER_PROFILE_ZONE("Parser::BlockStatement");
+  // reserve the span first, the spans of a parse are in preorder, sorted by start
+  const std::size_t span_index = this->m_new_block_spans.size();
+  const std::size_t nodes = this->m_node_count;
+  const std::size_t start = this->_offsetOf(this->m_lookahead);
+  if (this->m_incremental) {
+    this->m_new_block_spans.push_back({start, 0, 0, nullptr, false});
+  }
+
+  this->_eat(TokenKind::LeftBrace);
   
-  // std::cout << "meet a BlockStatement: body.empty():" << body.empty() << std::endl;
-  // std::cout << "body.is_null:" << body.is_null() << std::endl;
-  // std::cout << "body.is_array" << body.is_array() << std::endl;
-  // std::cout << "body.as_array().size()" << body.as_array().size() << std::endl;
+  // if is an empty block, the body is an empty list, which in json is []
+  auto&& body = this->m_lookahead.kind == TokenKind::RightBrace ? 
+    ast::NodeList<ast::Statement>{} : this->StatementList(TokenKind::RightBrace);
 
-  this->_eat("}");
+  if (this->m_diagnostics && this->m_lookahead.empty()) {
+    // diagnostics mode: a block left open at the end of input keeps its statements
+    this->m_diagnostics->add({DiagnosticKind::UnexpectedEndOfInput, TokenKind::RightBrace, this->m_text.size(), 0});
+  } else {
+    this->_eat(TokenKind::RightBrace);
+  }
 
-  return json::object{
-    {"type", "BlockStatement"},
-    {"body", body}
-  };
+  auto* block = this->_locate(this->_make<ast::BlockStatement>(body), start);
+  if (this->m_incremental) {
+    auto& span = this->m_new_block_spans[span_index];
+    span.end = this->m_last_end;
+    span.nodes = this->m_node_count - nodes;
+    span.statement = block;
+  }
+  return block;
 }
 
 /**
@@ -112,43 +787,63 @@ json::value Parser::BlockStatement() {
  *  : ";"
  *  ;
  */
-json::value Parser::EmptyStatement() {
-  this->_eat(";");
-  return json::object{
-    {"type", "EmptyStatement"}
-  };
+ast::Statement* Parser::EmptyStatement() {
+  LETTER_PROFILE_ZONE("Parser::EmptyStatement");
+  auto token = this->_eat(TokenKind::Semicolon);
+  return this->_locate(this->_make<ast::EmptyStatement>(), token.offset);
 }
 
 /**
  * Expression
- *  : Literal
+ *  : BinaryExpression(lowest precedence)
  *  ;
  */
-json::value Parser::Expression() {
-  return this->AssignmentExpression();
-  // return this->AdditiveExpression();
+ast::Expression* Parser::Expression() {
+  LETTER_PROFILE_ZONE("Parser::Expression");
+  return this->BinaryExpression(1);
 }
 
 /**
- * AssignmentExpression
- *  : AdditiveExpression
- *  | LeftHandSideExpression AssignmentOperator AssignmentExpression
+ * BinaryExpression(min_precedence), precedence climbing over the operator table, see `operatorInfo`
+ *  : PrimaryExpression
+ *  | BinaryExpression MULTIPLICATIVE_OPERATOR BinaryExpression       (3, left associative)
+ *  | BinaryExpression ADDITIVE_OPERATOR BinaryExpression             (2, left associative)
+ *  | LeftHandSideExpression AssignmentOperator BinaryExpression      (1, right associative)
+ *  ;
+ * AssignmentOperator
+ *  : SIMPLE_ASSIGN
+ *  | COMPLEX_ASSIGN
  *  ;
  */
-json::value Parser::AssignmentExpression() {
-  // 赋值表达式的运算优先级比BinaryExpression的优先级更低，所以放在更外层
-  auto&& left = this->AdditiveExpression();
+ast::Expression* Parser::BinaryExpression(uint8_t min_precedence) {
+  LETTER_PROFILE_ZONE("Parser::BinaryExpression");
+  const std::size_t start = this->_offsetOf(this->m_lookahead); // of `left`, and of every node built on it
+  auto* left = this->PrimaryExpression();
+
+  while (true) {
+    auto&& info = operatorInfo(this->m_lookahead.kind);
+    if (info.precedence == 0 || info.precedence < min_precedence) {
+      break; // not an operator, or binds looser than the caller: `left` is complete
+    }
+
+    auto op_token = this->_eat(this->m_lookahead.kind);
+    auto op = ast::operatorFromText(op_token.value);
+
+    if (info.assignment) {
+      // 赋值表达式的运算优先级比BinaryExpression的优先级更低，左边只能是Identifier
+      auto* target = this->_checkValidAssignmentTarget(left, op_token);
+      auto* right = this->BinaryExpression(info.precedence);
+      left = this->_locate(this->_make<ast::AssignmentExpression>(op, target, right), start);
+      continue;
+    }
 
-  if (!this->_isAssignmentOperator(this->m_lookahead)) {
-    return left; // if there is no assign op after first 'AdditiveExpression', that is 'AdditiveExpression' itself
+    auto* right = this->BinaryExpression(info.right_associative ? info.precedence : info.precedence + 1);
+
+    // the new parent only points to `left`, the subtree is never copied
+    left = this->_locate(this->_make<ast::BinaryExpression>(op, left, right), start);
   }
 
-  return json::object{
-    {"type", "AssignmentExpression"},
-    {"operator", this->AssignmentOperator()["value"]},
-    {"left", _checkValidAssignmentTarget(left)},
-    {"right", this->AssignmentExpression()}
-  };
+  return left;
 }
 
 /**
@@ -156,7 +851,8 @@ json::value Parser::AssignmentExpression() {
  * : Identifier
  * ;
  */
-json::value Parser::LeftHandSideExpression() {
+ast::Expression* Parser::LeftHandSideExpression() {
+  LETTER_PROFILE_ZONE("Parser::LeftHandSideExpression");
   return this->Identifier();
 }
 
@@ -165,60 +861,10 @@ json::value Parser::LeftHandSideExpression() {
  * : IDENTIRIFER
  * ;
  */
-json::value Parser::Identifier() {
-  auto&& name = this->_eat("IDENTIRIFER");
-  return json::object{
-    {"type", "Identifier"},
-    {"name", name["value"]}
-  };
-}
-
-/**
- * Generic binary expression.
- */
-json::value Parser::_BinaryExpression(std::function<json::value(void)> builder, 
-    const Tokenizer::TokenType& operator_token) {
-  auto&& left = builder();
-
-  while (this->m_lookahead["type"].as_string() == operator_token.value()) {
-    auto&& op = this->_eat(operator_token.value());
-  
-    // auto&& right = this->MultiplicativeExpression();
-    auto&& right = builder();
-
-    left = json::object{
-      {"type", "BinaryExpression"},
-      {"operator", op["value"]},
-      {"left", left},
-      {"right", right}
-    };
-  }
-
-  return left;
-}
-
-/**
- * AdditiveExpression
- *  : MultiplicativeExpression
- *  | AdditiveExpression ADDITIVE_OPERATOR MultiplicativeExpression
- *  ;
- */
-json::value Parser::AdditiveExpression() {
-  return _BinaryExpression(
-      std::bind(&Parser::MultiplicativeExpression, this),
-      "ADDITIVE_OPERATOR");
-}
-
-/**
- * MultiplicativeExpression
- *  : PrimaryExpression
- *  | MultiplicativeExpression ADDITIVE_OPERATOR PrimaryExpression
- *  ;
- */
-json::value Parser::MultiplicativeExpression() {
-  return _BinaryExpression(
-      std::bind(&Parser::PrimaryExpression, this),
-      "MULTIPLICATIVE_OPERATOR");
+ast::Expression* Parser::Identifier() {
+  LETTER_PROFILE_ZONE("Parser::Identifier");
+  auto name = this->_eat(TokenKind::Identifier);
+  return this->_locate(this->_make<ast::Identifier>(name.atom), name.offset);
 }
 
 /**
@@ -228,14 +874,13 @@ json::value Parser::MultiplicativeExpression() {
  *  | LeftHandSideExpression
  *  ;
  */
-json::value Parser::PrimaryExpression() {
+ast::Expression* Parser::PrimaryExpression() {
+  LETTER_PROFILE_ZONE("Parser::PrimaryExpression");
   if (this->_isLiteral(this->m_lookahead)) {
     return this->Literal();
   } 
 
-  auto&& type = this->m_lookahead["type"].as_string();
-
-  if (type == "(") {
+  if (this->m_lookahead.kind == TokenKind::LeftParen) {
     return this->ParenthesizedExpression();
   } else {
     return this->LeftHandSideExpression();
@@ -247,76 +892,83 @@ json::value Parser::PrimaryExpression() {
  *  : "(" Expression ")"
  *  ;
  */
-json::value Parser::ParenthesizedExpression() {
-  this->_eat("(");
-  auto&& expression = this->Expression(); // here inside ( ) must have AN expression, or throw error
+ast::Expression* Parser::ParenthesizedExpression() {
+  LETTER_PROFILE_ZONE("Parser::ParenthesizedExpression");
+  this->_eat(TokenKind::LeftParen);
+  auto* expression = this->Expression(); // here inside ( ) must have AN expression, or throw error
 
-  this->_eat(")");
+  this->_eat(TokenKind::RightParen);
 
   return expression;
 }
 
-/**
- * AssignmentOperator
- *  : SIMPLE_ASSIGN
- *  | COMPLEX_ASSIGN
- *  ;
- */
-json::value Parser::AssignmentOperator() {
-  if (this->m_lookahead["type"].as_string() == "SIMPLE_ASSIGN") {
-    return this->_eat("SIMPLE_ASSIGN");
-  } else {
-    return this->_eat("COMPLEX_ASSIGN");
-  }
-}
-
 /**
  * Literal
  * consistent of an `Expression`
  */
-json::value Parser::Literal()
+ast::Expression* Parser::Literal()
 {
+  LETTER_PROFILE_ZONE("Parser::Literal");
   assert(!this->m_lookahead.empty());
-  auto&& type = this->m_lookahead["type"].as_string(); 
-  if (type == "NUMBER") {
+  auto kind = this->m_lookahead.kind; 
+  if (kind == TokenKind::Number) {
     return this->NumericLiteral();
-  } else if (type == "STRING") {
+  } else if (kind == TokenKind::String) {
     return this->StringLiteral();
   }
 
   throw Exception("Unexpected literal production");
 }
 
-json::value Parser::StringLiteral() {
-  auto&& token = this->_eat("STRING");
+ast::Expression* Parser::StringLiteral() {
+  LETTER_PROFILE_ZONE("Parser::StringLiteral");
+  auto token = this->_eat(TokenKind::String);
  
-  auto&& str = token["value"].as_string();
-  return json::object{
-    {"type", "StringLiteral"},
-    {"value", str.substr(1, str.size() - 2)} // 去除前后的引号
-  };
+  // the atom is the one of the contents, 去除前后的引号
+  return this->_locate(this->_make<ast::StringLiteral>(token.atom), token.offset);
 }
 
-json::value Parser::NumericLiteral() {
-  auto&& token = this->_eat("NUMBER");
+ast::Expression* Parser::NumericLiteral() {
+  LETTER_PROFILE_ZONE("Parser::NumericLiteral");
+  auto token = this->_eat(TokenKind::Number);
 
-  return json::object{
-    {"type", "NumericLiteral"},
-    {"value", std::stoi(token["value"].as_string())}
-  };
+  // converted by the tokenizer, only a value which does not fit is left to report
+  auto value = token.number;
+  if (value.kind == NumberValue::Kind::OutOfRange) {
+    if (!this->m_diagnostics) {
+      throw Exception("Number out of range: " + std::string(token.value));
+    }
+    this->_fail({DiagnosticKind::NumberOutOfRange, TokenKind::EndOfFile, this->_offsetOf(token), token.value.size()});
+    value = NumberValue();
+  }
+
+  return this->_locate(this->_make<ast::NumericLiteral>(value), token.offset);
 }
 
-json::value Parser::_eat(const std::string& token_type) {
+Token Parser::_eat(TokenKind token_kind) {
   auto token = this->m_lookahead;
 
   if (token.empty()) {
-    throw Exception("Unexpected end of input, expected: " + token_type);
+    if (this->m_diagnostics) {
+      return this->_fail({DiagnosticKind::UnexpectedEndOfInput, token_kind, this->m_text.size(), 0});
+    }
+    throw Exception(std::string("Unexpected end of input, expected: ") + tokenTypeName(token_kind));
   }
 
-  if (token["type"].as_string() != token_type) {
-    throw Exception("Unexpected token: " + token["value"].to_string() + ", expected: " + token_type);
+  if (token.kind != token_kind) {
+    if (this->m_diagnostics) {
+      if (token.kind == TokenKind::Invalid) {
+        this->_panic(); // the tokenizer recorded it
+        return {};
+      }
+      return this->_fail({DiagnosticKind::UnexpectedToken, token_kind, this->_offsetOf(token), token.value.size()});
+    }
+    throw Exception("Unexpected token: " + json::value(std::string(token.value)).to_string() + 
+        ", expected: " + tokenTypeName(token_kind));
   }
   
+  this->m_last_end = this->_offsetOf(token) + token.value.size();
+
   // TimeCounter t;
   // get next token after eat for lookahead
   this->m_lookahead = this->m_tokenizer->getNextToken();
@@ -325,31 +977,74 @@ json::value Parser::_eat(const std::string& token_type) {
   return token;
 }
 
-bool Parser::_isAssignmentOperator(const json::value& token) const {
-  auto&& type = token.at("type").as_string();
+bool Parser::_isLiteral(const Token& token) const {
+  return token.kind == TokenKind::Number || token.kind == TokenKind::String;
+}
 
-  if (type == "SIMPLE_ASSIGN" ||
-      type == "COMPLEX_ASSIGN") {
-    return true;
-  } else {
-    return false;
+/**
+ * Whether the token is an Assignment Target
+ */
+ast::Expression* Parser::_checkValidAssignmentTarget(ast::Expression* expression, const Token& op) {
+  if (expression->type == ast::NodeType::Identifier) {
+    return expression;
+  } 
+  if (this->m_diagnostics) {
+    this->_fail({DiagnosticKind::InvalidAssignmentTarget, TokenKind::EndOfFile, this->_offsetOf(op), op.value.size(), expression});
+    return expression;
+  } {
+    throw Exception("Invalid left-hand side in assignment expression:\n" + ast::toJson(*expression, this->m_symbols).to_string());
   }
 }
 
-bool Parser::_isLiteral(const json::value& token) const {
-  auto&& type = token.at("type").as_string();
+/**
+ * @brief: diagnostics mode, record a syntax error and unwind to the StatementList of the statement
+ * Returns an empty token in place of the one expected. Nothing more is recorded until `_synchronize`.
+ */
+Token Parser::_fail(const Diagnostic& diagnostic) {
+  if (!this->m_panic) {
+    this->m_diagnostics->add(diagnostic);
+    this->_panic();
+  }
+  return {};
+}
 
-  return type == "NUMBER" || type == "STRING";
+/**
+ * @brief: the lookahead is put aside and replaced by the end of input, which ends every production
+ * on the way up without consuming a token and without a check of its own
+ */
+void Parser::_panic() {
+  if (!this->m_panic) {
+    this->m_panic = true;
+    this->m_resume = this->m_lookahead;
+    this->m_lookahead = Token{};
+  }
 }
 
 /**
- * Whether the token is an Assignment Target
+ * @brief: skip from the error to the start of the next statement of the same StatementList
+ * That is past the next ";" or "{ ... }" at the depth of the list, or up to the "}" closing the list,
+ * which is left to its BlockStatement. A "}" closing nothing at top level is skipped.
  */
-const json::value& Parser::_checkValidAssignmentTarget(const json::value& expression) const {
-  if (expression.at("type").as_string() == "Identifier") {
-    return expression;
-  } {
-    throw Exception("Invalid left-hand side in assignment expression:\n" + expression.to_string());
+void Parser::_synchronize(bool in_block) {
+  this->m_panic = false;
+  this->m_lookahead = this->m_resume;
+
+  std::size_t depth = 0;
+  while (!this->m_lookahead.empty()) {
+    auto kind = this->m_lookahead.kind;
+    if (kind == TokenKind::RightBrace && depth == 0 && in_block) {
+      return;
+    }
+
+    this->m_last_end = this->_offsetOf(this->m_lookahead) + this->m_lookahead.value.size();
+    this->m_lookahead = this->m_tokenizer->getNextToken();
+
+    if (kind == TokenKind::LeftBrace) {
+      ++ depth;
+    } else if ((kind == TokenKind::RightBrace && (depth == 0 || --depth == 0)) ||
+        (kind == TokenKind::Semicolon && depth == 0)) {
+      return;
+    }
   }
 }
 
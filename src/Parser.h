@@ -1,60 +1,360 @@
 #pragma once
 
+#include <cstddef>
 #include <optional>
 #include <string>
 #include <memory>
-
-#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "json.hpp"
 
 #include "Tokenizer.h"
+#include "SourceBuffer.h"
+#include "Arena.h"
+#include "Ast.h"
+#include "Diagnostic.h"
+#include "Instrument.h"
+#include "ParseCache.h"
+#include "ParseMany.h"
+#include "SourceLocation.h"
 
 namespace letter {
 
-class Parser {
+/**
+ * @brief: a change of the source text, `removed` bytes at `offset` replaced by `inserted`
+ */
+struct TextEdit {
+  std::size_t offset;
+  std::size_t removed;
+  std::string inserted;
+};
+
+/**
+ * @brief: how much of the previous tree the last parse reused
+ */
+struct ReparseStats {
+  std::size_t nodes = 0;              // nodes of the new tree
+  std::size_t reused_nodes = 0;       // nodes taken from the previous tree
+  std::size_t reused_statements = 0;  // statements and blocks taken as a whole
+  bool full = true;                   // parsed from scratch, nothing reused
+
+  inline double reusedFraction() const {
+    return this->nodes ? static_cast<double>(this->reused_nodes) / this->nodes : 0;
+  }
+};
+
+class Parser : private ast::BodyParser {
 private:
-  std::string m_string;
+  SourceBuffer m_source;
   
   std::unique_ptr<Tokenizer> m_tokenizer;
 
-  json::value m_lookahead;  
+  Token m_lookahead;  
+
+  Arena m_arena; // every node of the last parse lives here
+
+  SymbolTable m_symbols; // names and strings of the last parse
+
+  std::vector<ast::Statement*> m_statement_stack; // scratch of the StatementLists being built
+
+  /**
+   * @brief: source range of a parsed statement, which can be reused as is
+   * while the text of the range is unchanged
+   */
+  struct _Span {
+    std::size_t start;    // offset of the first token
+    std::size_t end;      // end offset of the last token, a ";" or a "}"
+    std::size_t nodes;    // size of the subtree
+    ast::Statement* statement;
+    bool linked;          // top-level only: the next statement follows, with nothing edited in between
+
+    static inline bool before(const _Span& span, std::size_t offset) { return span.start < offset; }
+  };
+
+  bool m_incremental;                   // keep the spans below, to reparse edits
+  std::vector<_Span> m_top_spans;       // statements of the Program, in order
+  std::vector<_Span> m_block_spans;     // BlockStatements at every depth, by start
+  std::vector<_Span> m_new_top_spans;   // scratch of the running parse
+  std::vector<_Span> m_new_block_spans; // scratch of the running parse, in preorder
+  std::vector<ast::Statement*> m_program_body; // body of the Program when incremental, not copied into the arena
+
+  std::string_view m_text;              // text being tokenized, the source or a part of it
+  std::size_t m_last_end;               // end offset of the last eaten token
+  std::size_t m_node_count;             // nodes of the running parse, reused ones included
+  std::size_t m_full_parse_bytes;       // arena usage of the last full parse
+  ReparseStats m_reparse_stats;
+
+  unsigned m_threads;                   // workers of a parallel parse, 1 for none
+  std::size_t m_parallel_size;          // smallest source parsed in parallel
+  std::vector<std::unique_ptr<Parser>> m_workers;
+  std::vector<ParseResult> m_parts;     // trees of the parts of the last parallel parse
+  std::size_t m_part_count;             // parts holding statements of the last tree, 0 if it was parsed serially
+
+  std::unique_ptr<ParseCache> m_cache;  // nullptr if not caching
+  bool m_cache_hit;                     // the last tree was loaded from the cache
+
+  Diagnostics* m_diagnostics;           // diagnostics mode if not nullptr, during the parse only
+  bool m_panic;                         // diagnostics mode: unwinding from an error, see `_fail`
+  Token m_resume;                       // diagnostics mode: the lookahead at the error
+
+  bool m_locations;                     // fill the span of every node
+  LineIndex m_lines;                    // of the source, built on the first lookup
+  bool m_lines_built;
+
+  bool m_lazy_blocks;                   // skip block bodies, see `setLazyBlocks`
+  ast::Program* m_lazy_program;         // the last tree if its bodies may be lazy, nullptr otherwise
 
 public:
   Parser();
 
   json::value parse(const std::string &str);
+
+  /**
+   * @brief: parse the file at `path`, reading straight from a read-only mapping of it
+   * non-regular files (pipes...) are streamed into a buffer instead
+   */
+  json::value parseFile(const std::string &path);
+
+  /**
+   * @brief: parse into the typed AST, `parse` is `ast::toJson(*parseAst(str))`
+   * The tree is owned by the parser, it stays valid until the next parse.
+   * Later passes (slot resolution...) may annotate it in place.
+   */
+  ast::Program* parseAst(const std::string &str);
+  ast::Program* parseFileAst(const std::string &path);
+
+  /**
+   * @brief: parse a copy of `text`, made over the copy of the last source, which keeps its capacity
+   * So do the arena, the symbols and the scratch stacks: once they have grown to the size of the
+   * sources, a parse allocates nothing, only a syntax error does. `text` must not view `source()`.
+   * See `ParseContext`.
+   */
+  ast::Program* parseAstReusing(std::string_view text);
+
+  /**
+   * @brief: diagnostics mode, record syntax errors into `diagnostics` instead of throwing
+   * `diagnostics` is cleared first. After an error, the statement it is in is dropped, and
+   * parsing resumes past the next ";" or block of the same list, or at the "}" closing it.
+   * The Program holds every statement which parsed, and `diagnostics` every error, in one pass.
+   * The first diagnostic is the error the throwing parse raises. A block left open at the end
+   * of input keeps its statements. Diagnostics mode parses serially, from scratch, and is not
+   * cached. It throws only if the file can not be read.
+   */
+  json::value parse(const std::string &str, Diagnostics& diagnostics);
+  ast::Program* parseAst(const std::string &str, Diagnostics& diagnostics);
+  ast::Program* parseFileAst(const std::string &path, Diagnostics& diagnostics);
+  ast::Program* parseAstReusing(std::string_view text, Diagnostics& diagnostics);
+
+  /**
+   * @brief: text of a diagnostic of the last parse
+   */
+  inline std::string diagnosticMessage(const Diagnostic& diagnostic) const {
+    return letter::diagnosticMessage(diagnostic, this->m_source.view(), this->m_symbols);
+  }
+
+  static constexpr std::size_t kParallelSize = 1024 * 1024;
+
+  /**
+   * @brief: parse sources of `min_size` bytes or more on `threads` workers, 1 (the default) for none
+   * The source is cut between top-level statements (see `splitTopLevel`), the parts are parsed in
+   * parallel, and their statements are joined into one Program, with the atoms renumbered as a
+   * serial parse numbers them. If a part fails, the source is parsed again serially, so the
+   * tree and the errors are always those of a serial parse. Incremental parses are serial.
+   */
+  inline void setThreads(unsigned threads, std::size_t min_size = kParallelSize) {
+    this->m_threads = threads;
+    this->m_parallel_size = min_size;
+  }
+
+  /**
+   * @brief: cache the trees of `parse`, `parseFile` and their Ast forms in `directory`, "" to stop
+   * A source parsed before is hashed and its tree decoded from the cache, without tokenizing it.
+   * A source not in the cache is parsed, then its tree is stored. See `ParseCache`.
+   * Incremental parses are not cached, a reparse needs the source range of every statement.
+   */
+  void setCacheDirectory(const std::string& directory);
+
+  /**
+   * @brief: whether the tree of the last parse came from the cache
+   */
+  inline bool cacheHit() const { return this->m_cache_hit; }
+
+  /**
+   * @brief: record the source span of every node, and add "loc" to the json of `parse`
+   * Off by default, turning it on only affects the parses after it. Spans are offsets only,
+   * lines and columns are looked up in `lineIndex`. Located parses are not cached,
+   * the binary format has no spans.
+   */
+  inline void setLocations(bool locations) {
+    if (locations != this->m_locations) {
+      // statements of the previous tree are not taken back, they were located otherwise
+      this->m_top_spans.clear();
+      this->m_block_spans.clear();
+    }
+    this->m_locations = locations;
+  }
+  inline bool locations() const { return this->m_locations; }
+
+  /**
+   * @brief: the line index of the source of the last parse, built on the first call after it
+   */
+  const LineIndex& lineIndex();
+
+  inline SourcePosition position(uint32_t offset) { return this->lineIndex().position(offset); }
+
+  /**
+   * @brief: skip the bodies of BlockStatements, and parse each one on its first non-const `statements()`
+   * call, or by `validate`; the const `statements()` never parses, it throws on a body not parsed yet.
+   * A body is found by matching its braces without tokenizing it, so a syntax error in it is only
+   * thrown when it is parsed. Off by default, turning it on only affects the parses after it, a body is
+   * parsed with the settings of the parse which skipped it. Bodies are parsed by this parser from the
+   * source of the last parse: a lazy tree must not outlive the parser, and must be read before the next
+   * parse; `release` parses them all, and so does the json form of `parse`. Lazy parses are serial, not
+   * incremental and not cached; diagnostics mode parses every body.
+   */
+  inline void setLazyBlocks(bool lazy) { this->m_lazy_blocks = lazy; }
+
+  /**
+   * @brief: parse every lazy body under `node`
+   * throw `letter::Exception` on the first syntax error, in source order
+   */
+  void validate(ast::Node& node);
+
+  /**
+   * @brief: keep what an incremental reparse needs: the source range of the statements
+   * Off by default, turning it on only affects the parses after it.
+   */
+  inline void setIncremental(bool incremental) { this->m_incremental = incremental; }
+
+  /**
+   * @brief: apply `edit` to the source of the last parse, and parse the result
+   * The tree is the same as a full parse of the edited text. The edited text is
+   * lexed again from the last intact statement before the edit, and parsing takes
+   * back every statement of the previous tree whose text is unchanged: top-level
+   * statements and BlockStatements at any depth. It stops parsing as soon as the
+   * rest of the program is known to be unchanged.
+   * Without `setIncremental(true)`, or to compact the arena once old trees use too
+   * much of it, the edited text is parsed from scratch.
+   * The previous tree must not have been rewritten in place (e.g. by `optimize`),
+   * its nodes are shared with the new one.
+   * throw `letter::Exception` on a syntax error, or if the edit is out of the source;
+   * after a syntax error, the next edit applies to the text that failed to parse.
+   */
+  json::value reparse(const TextEdit& edit);
+  ast::Program* reparseAst(const TextEdit& edit);
+
+  inline const ReparseStats& reparseStats() const { return this->m_reparse_stats; }
+
+  /**
+   * @brief: text of the last parse
+   */
+  inline std::string_view source() const { return this->m_source.view(); }
+
+  /**
+   * @brief: drop the tree, the symbols and the source of the last parse, their memory is kept for the next one
+   */
+  void clear();
+
+  /**
+   * @brief: hand the arena and the symbols of the last parse, which hold its tree, over to the caller
+   * The parser goes on with empty ones, the part arenas of a parallel parse go along with its tree.
+   * Not for incremental parses, the parser keeps their Program body. The lazy bodies of the tree are
+   * parsed first, as `validate` does: throw `letter::Exception` on a syntax error in one, nothing is
+   * handed over then.
+   */
+  void release(Arena& arena, SymbolTable& symbols);
+
+  inline const Arena& arena() const { return this->m_arena; }
+  inline Arena& arena() { return this->m_arena; }
+
+  inline const SymbolTable& symbols() const { return this->m_symbols; }
+  inline SymbolTable& symbols() { return this->m_symbols; }
+
 private:
-  json::value Program();
-  
-  json::value StatementList(const std::optional<std::string>& stop_lookahead_tokentype = std::nullopt);
+  ast::Program* _parseSource();
+  ast::Program* _parseFromScratch();
+  ast::Program* _parseDiagnosing(Diagnostics& diagnostics);
+  ast::Program* _parse();
+  ast::Program* _parseView(std::string_view text);
+  ast::Program* _parseParallel();
+  void _shiftSpans(const TextEdit& edit);
+  void _moveReused(ast::Statement* statement, std::size_t start);
+  ast::Statement* _reuseBlock();
+  ast::Statement* _lazyBlock();
+  void parseBody(ast::BlockStatement& block) override;
+  ast::NodeList<ast::Statement> _takeStatements(std::size_t base);
 
-  json::value Statement();
-  json::value ExpressionStatement();
-  json::value BlockStatement();
-  json::value EmptyStatement();
+  ast::Program* Program();
+  
+  ast::NodeList<ast::Statement> StatementList(std::optional<TokenKind> stop_lookahead_tokenkind = std::nullopt);
 
-  json::value Expression();
-  json::value AssignmentExpression();
-  json::value LeftHandSideExpression();
-  json::value Identifier();
-  json::value _BinaryExpression(std::function<json::value(void)> builder, const Tokenizer::TokenType& operator_token);
-  json::value AdditiveExpression();
-  json::value MultiplicativeExpression();
-  json::value PrimaryExpression();
-  json::value ParenthesizedExpression();
+  ast::Statement* Statement();
+  ast::Statement* ExpressionStatement();
+  ast::Statement* BlockStatement();
+  ast::Statement* EmptyStatement();
 
-  json::value AssignmentOperator();
+  ast::Expression* Expression();
+  ast::Expression* BinaryExpression(uint8_t min_precedence);
+  ast::Expression* LeftHandSideExpression();
+  ast::Expression* Identifier();
+  ast::Expression* PrimaryExpression();
+  ast::Expression* ParenthesizedExpression();
 
-  json::value Literal();
-  json::value StringLiteral(); 
-  json::value NumericLiteral();
+  ast::Expression* Literal();
+  ast::Expression* StringLiteral(); 
+  ast::Expression* NumericLiteral();
 
 private:
-  json::value _eat(const std::string& token_type);
-  bool _isAssignmentOperator(const json::value& token) const ;
-  bool _isLiteral(const json::value& token) const ;
-  const json::value& _checkValidAssignmentTarget(const json::value& value) const ;
+  template <typename T, typename... Args>
+  inline T* _make(Args&&... args) {
+    ++ this->m_node_count;
+    auto* node = this->m_arena.make<T>(std::forward<Args>(args)...);
+    if constexpr (instrument::kEnabled) {
+      std::size_t bytes = sizeof(T);
+      if constexpr (std::is_same<T, ast::Program>::value || std::is_same<T, ast::BlockStatement>::value) {
+        bytes += node->body.size * sizeof(ast::Statement*);
+      }
+      instrument::countNode(T::kType, bytes);
+    }
+    return node;
+  }
+
+  inline std::size_t _offsetOf(const Token& token) const {
+    return token.empty() ? this->m_text.size() : token.offset;
+  }
+
+  /**
+   * @brief: span `node` from `start` to the end of the last eaten token, if locating
+   */
+  template <typename T>
+  inline T* _locate(T* node, std::size_t start) {
+    if (this->m_locations) {
+      node->span = {static_cast<uint32_t>(start), static_cast<uint32_t>(this->m_last_end - start)};
+    }
+    return node;
+  }
+
+  /**
+   * @brief: a Program spans the whole text, trivia included
+   */
+  inline ast::Program* _locateProgram(ast::Program* program) {
+    if (this->m_locations) {
+      program->span = {0, static_cast<uint32_t>(this->m_text.size())};
+    }
+    return program;
+  }
+
+  inline const LineIndex* _jsonLines() { return this->m_locations ? &this->lineIndex() : nullptr; }
+
+  Token _eat(TokenKind token_kind);
+  bool _isLiteral(const Token& token) const ;
+  ast::Expression* _checkValidAssignmentTarget(ast::Expression* expression, const Token& op);
+
+  Token _fail(const Diagnostic& diagnostic);
+  void _panic();
+  void _synchronize(bool in_block);
 };
 
 } // namespace letter
@@ -0,0 +1,263 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+namespace letter {
+namespace profile {
+
+bool writeChromeTrace(const std::string& path) {
+  std::ofstream ofs(path);
+  ofs << chromeTrace().to_string() << std::endl;
+  return static_cast<bool>(ofs);
+}
+
+void printSummary(std::ostream& os) {
+  if (!kEnabled) {
+    os << "profile: off, configure with -DLETTER_PROFILE=ON" << std::endl;
+    return;
+  }
+  os << std::left << std::setw(36) << "zone" << std::right << std::setw(12) << "count" 
+    << std::setw(14) << "total(us)" << std::setw(10) << "p50(ns)" << std::setw(10) << "p90(ns)" 
+    << std::setw(10) << "p99(ns)" << std::setw(12) << "max(ns)" << std::endl;
+  for (auto&& zone : aggregate()) {
+    os << std::left << std::setw(36) << zone.name << std::right << std::setw(12) << zone.count 
+      << std::setw(14) << zone.total_ns / 1000 << std::setw(10) << zone.p50_ns << std::setw(10) << zone.p90_ns
+      << std::setw(10) << zone.p99_ns << std::setw(12) << zone.max_ns << std::endl;
+  }
+}
+
+#if LETTER_PROFILE
+
+/**
+ * @brief: log-linear histogram of durations, 8 buckets per power of 2 (HdrHistogram style)
+ */
+struct _Histogram {
+  static constexpr std::size_t kSubBits = 3;
+  static constexpr std::size_t kBuckets = (64 - kSubBits + 1) << kSubBits;
+
+  std::array<uint32_t, kBuckets> counts{};
+
+  static inline std::size_t bucket(uint64_t ns) {
+    if (ns < (1u << kSubBits)) {
+      return static_cast<std::size_t>(ns);
+    }
+    const unsigned exponent = 63 - __builtin_clzll(ns);  // >= kSubBits
+    const uint64_t mantissa = (ns >> (exponent - kSubBits)) & ((1u << kSubBits) - 1);
+    return ((exponent - kSubBits + 1) << kSubBits) + mantissa;
+  }
+
+  // the middle of the durations of `bucket`
+  static inline uint64_t value(std::size_t bucket) {
+    if (bucket < (1u << kSubBits)) {
+      return bucket;
+    }
+    const unsigned exponent = static_cast<unsigned>(bucket >> kSubBits) + kSubBits - 1;
+    const uint64_t mantissa = bucket & ((1u << kSubBits) - 1);
+    const uint64_t low = (uint64_t(1) << exponent) | (mantissa << (exponent - kSubBits));
+    return low + (uint64_t(1) << (exponent - kSubBits)) / 2;
+  }
+};
+
+struct _SiteStats {
+  uint64_t count = 0;
+  uint64_t total_ns = 0;
+  uint64_t max_ns = 0;
+  _Histogram histogram;
+};
+
+// sites a thread buffer holds without moving, a zone only ever writes to its own site in place
+static constexpr std::size_t kMaxSites = 1024;
+
+struct _Event {
+  uint32_t site;
+  uint64_t begin;
+  uint64_t end;
+};
+
+/**
+ * @brief: what a thread recorded, only that thread writes it
+ * owned by the registry, it outlives the thread so that its zones can still be read.
+ * Sized up front, so that a zone never allocates: one entry per registered site, and room for
+ * `capacity` events.
+ */
+struct _ThreadBuffer {
+  uint32_t tid;
+  std::vector<_SiteStats> sites;  // indexed by site id
+  std::vector<_Event> events;
+  std::size_t capacity = 0;       // events kept, see `setEventCapacity`
+  uint64_t dropped = 0;           // events past the capacity
+};
+
+struct _Registry {
+  std::mutex mutex;
+  std::vector<std::string> sites;
+  std::vector<std::unique_ptr<_ThreadBuffer>> threads;
+  std::size_t capacity = 1 << 20;
+  std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+};
+
+static _Registry& _registry() {
+  static _Registry s_registry;
+  return s_registry;
+}
+
+static thread_local _ThreadBuffer* t_buffer = nullptr;
+
+static inline uint64_t _now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - _registry().origin).count();
+}
+
+static _ThreadBuffer& _buffer() {
+  if (!t_buffer) {
+    auto&& registry = _registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.threads.push_back(std::make_unique<_ThreadBuffer>());
+    t_buffer = registry.threads.back().get();
+    t_buffer->tid = static_cast<uint32_t>(registry.threads.size());
+    t_buffer->sites.reserve(kMaxSites);
+    t_buffer->sites.resize(registry.sites.size());
+    t_buffer->capacity = registry.capacity;
+    t_buffer->events.reserve(registry.capacity);
+  }
+  return *t_buffer;
+}
+
+ZoneSite::ZoneSite(const char* name) {
+  auto&& registry = _registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  this->m_id = static_cast<uint32_t>(registry.sites.size());
+  assert(this->m_id < kMaxSites);
+  registry.sites.emplace_back(name);
+  // within the reserved room: the sites of running zones stay where they are
+  for (auto&& thread : registry.threads) {
+    thread->sites.resize(registry.sites.size());
+  }
+}
+
+Zone::Zone(const ZoneSite& site) : m_site(site.id()), m_begin(_now()) {
+
+}
+
+Zone::~Zone() {
+  const uint64_t end = _now();
+  const uint64_t ns = end - this->m_begin;
+  auto&& buffer = _buffer();
+
+  auto&& site = buffer.sites[this->m_site];
+  ++site.count;
+  site.total_ns += ns;
+  site.max_ns = std::max(site.max_ns, ns);
+  ++site.histogram.counts[_Histogram::bucket(ns)];
+
+  if (buffer.events.size() < buffer.capacity) {
+    buffer.events.push_back(_Event{this->m_site, this->m_begin, end});
+  } else {
+    ++buffer.dropped;
+  }
+}
+
+void reset() {
+  auto&& registry = _registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  // zeroed in place, the memory stays for the next zones
+  for (auto&& thread : registry.threads) {
+    std::fill(thread->sites.begin(), thread->sites.end(), _SiteStats{});
+    thread->events.clear();
+    thread->dropped = 0;
+  }
+}
+
+void setEventCapacity(std::size_t events) {
+  auto&& registry = _registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.capacity = events;
+  for (auto&& thread : registry.threads) {
+    thread->capacity = events;
+    thread->events.reserve(events);
+  }
+}
+
+std::vector<ZoneStats> aggregate() {
+  auto&& registry = _registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  std::vector<ZoneStats> zones(registry.sites.size());
+  std::vector<_Histogram> histograms(registry.sites.size());
+  for (std::size_t id = 0; id < zones.size(); ++id) {
+    zones[id].name = registry.sites[id];
+  }
+  for (auto&& thread : registry.threads) {
+    for (std::size_t id = 0; id < thread->sites.size(); ++id) {
+      auto&& site = thread->sites[id];
+      zones[id].count += site.count;
+      zones[id].total_ns += site.total_ns;
+      zones[id].max_ns = std::max(zones[id].max_ns, site.max_ns);
+      for (std::size_t b = 0; b < _Histogram::kBuckets; ++b) {
+        histograms[id].counts[b] += site.histogram.counts[b];
+      }
+    }
+  }
+
+  for (std::size_t id = 0; id < zones.size(); ++id) {
+    auto&& zone = zones[id];
+    auto&& percentile = [&](double p) -> uint64_t {
+      const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p * zone.count + 0.5));
+      uint64_t seen = 0;
+      for (std::size_t b = 0; b < _Histogram::kBuckets; ++b) {
+        seen += histograms[id].counts[b];
+        if (seen >= rank) {
+          return std::min(_Histogram::value(b), zone.max_ns);
+        }
+      }
+      return zone.max_ns;
+    };
+    zone.p50_ns = percentile(0.50);
+    zone.p90_ns = percentile(0.90);
+    zone.p99_ns = percentile(0.99);
+  }
+
+  zones.erase(std::remove_if(zones.begin(), zones.end(), [](const ZoneStats& zone) { return zone.count == 0; }), 
+      zones.end());
+  std::sort(zones.begin(), zones.end(), [](const ZoneStats& a, const ZoneStats& b) { return a.total_ns > b.total_ns; });
+  return zones;
+}
+
+json::value chromeTrace() {
+  auto&& registry = _registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  json::array events;
+  uint64_t dropped = 0;
+  for (auto&& thread : registry.threads) {
+    for (auto&& event : thread->events) {
+      // microseconds, with the nanoseconds as decimals
+      events.emplace_back(json::object{
+        {"name", registry.sites[event.site]},
+        {"ph", "X"},
+        {"ts", event.begin / 1000.0},
+        {"dur", (event.end - event.begin) / 1000.0},
+        {"pid", 1},
+        {"tid", static_cast<unsigned>(thread->tid)},
+      });
+    }
+    dropped += thread->dropped;
+  }
+  return json::object{
+    {"traceEvents", events},
+    {"displayTimeUnit", "ns"},
+    {"otherData", json::object{{"dropped_events", static_cast<unsigned long long>(dropped)}}},
+  };
+}
+
+#endif // LETTER_PROFILE
+
+} // namespace profile
+} // namespace letter
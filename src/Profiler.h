@@ -0,0 +1,124 @@
+#pragma once
+
+#include "json.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Profile build: configure with -DLETTER_PROFILE=ON.
+ * `LETTER_PROFILE_ZONE("name")` then times the rest of the enclosing scope, zones nest.
+ * Every thread records into its own buffer, without locks or allocations; `reset`,
+ * `setEventCapacity`, `aggregate` and `chromeTrace` touch all the buffers, while no zone is
+ * running. Off by default: the macro expands to nothing, and the functions below are empty
+ * inline ones.
+ */
+#ifndef LETTER_PROFILE
+#define LETTER_PROFILE 0
+#endif
+
+namespace letter {
+namespace profile {
+
+constexpr bool kEnabled = LETTER_PROFILE;
+
+/**
+ * @brief: timings of one zone over all threads, percentiles are within about 5%
+ */
+struct ZoneStats {
+  std::string name;
+  uint64_t count = 0;
+  uint64_t total_ns = 0;
+  uint64_t p50_ns = 0;
+  uint64_t p90_ns = 0;
+  uint64_t p99_ns = 0;
+  uint64_t max_ns = 0;
+};
+
+#if LETTER_PROFILE
+
+/**
+ * @brief: a place of the code which is timed, made once by `LETTER_PROFILE_ZONE`
+ */
+class ZoneSite {
+private:
+  uint32_t m_id;
+
+public:
+  explicit ZoneSite(const char* name);
+  inline uint32_t id() const { return this->m_id; }
+};
+
+/**
+ * @brief: times its own lifetime, as one run of `site`
+ */
+class Zone {
+private:
+  uint32_t m_site;
+  uint64_t m_begin;
+
+public:
+  explicit Zone(const ZoneSite& site);
+  ~Zone();
+
+  Zone(const Zone&) = delete;
+  Zone& operator=(const Zone&) = delete;
+};
+
+#define LETTER_PROFILE_CONCAT_(a, b) a##b
+#define LETTER_PROFILE_CONCAT(a, b) LETTER_PROFILE_CONCAT_(a, b)
+#define LETTER_PROFILE_ZONE(name)                                                           \
+  static const ::letter::profile::ZoneSite LETTER_PROFILE_CONCAT(s_zone_site_, __LINE__)(name);  \
+  ::letter::profile::Zone LETTER_PROFILE_CONCAT(zone_, __LINE__)(LETTER_PROFILE_CONCAT(s_zone_site_, __LINE__))
+
+/**
+ * @brief: forget every recorded zone, keep the buffers for the next ones
+ * Only while no zone is running, on any thread.
+ */
+void reset();
+
+/**
+ * @brief: keep the trace events of at most `events` zones per thread, 1M by default
+ * Zones past it are still counted in `aggregate`, only left out of the trace. The room for them is
+ * reserved per thread up front, so that zones do not allocate. Only while no zone is running.
+ */
+void setEventCapacity(std::size_t events);
+
+/**
+ * @brief: per zone timings, the zone taking the most time first
+ * Times include the nested zones, a recursive zone (`Parser::Expression`...) is counted at every depth.
+ */
+std::vector<ZoneStats> aggregate();
+
+/**
+ * @brief: the recorded zones as Chrome trace events, for chrome://tracing or Perfetto
+ * {"traceEvents": [{"name": ..., "ph": "X", "ts": ..., "dur": ..., "pid": 1, "tid": ...}...]}
+ */
+json::value chromeTrace();
+
+#else
+
+#define LETTER_PROFILE_ZONE(name) do {} while (false)
+
+inline void reset() {}
+inline void setEventCapacity(std::size_t) {}
+inline std::vector<ZoneStats> aggregate() { return {}; }
+inline json::value chromeTrace() { return json::object{{"traceEvents", json::array{}}}; }
+
+#endif
+
+/**
+ * @brief: `chromeTrace` into the file at `path`, false if it could not be written
+ */
+bool writeChromeTrace(const std::string& path);
+
+/**
+ * @brief: `aggregate` as a table
+ */
+void printSummary(std::ostream& os);
+
+} // namespace profile
+} // namespace letter
@@ -0,0 +1,65 @@
+#include "Resolver.h"
+#include "Profiler.h"
+
+namespace letter {
+
+namespace {
+
+struct _Resolver {
+  std::vector<uint32_t> slot_of_atom; // indexed by atom
+  std::vector<Atom> names;            // indexed by slot
+
+  void resolve(ast::Node* node) {
+    switch (node->type) {
+    case ast::NodeType::Program:
+      for (auto* statement : static_cast<ast::Program*>(node)->body) {
+        this->resolve(statement);
+      }
+      break;
+    case ast::NodeType::BlockStatement:
+      for (auto* statement : static_cast<ast::BlockStatement*>(node)->statements()) {
+        this->resolve(statement);
+      }
+      break;
+    case ast::NodeType::ExpressionStatement:
+      this->resolve(static_cast<ast::ExpressionStatement*>(node)->expression);
+      break;
+    case ast::NodeType::AssignmentExpression: {
+      auto* e = static_cast<ast::AssignmentExpression*>(node);
+      this->resolve(e->left);
+      this->resolve(e->right);
+      break;
+    }
+    case ast::NodeType::BinaryExpression: {
+      auto* e = static_cast<ast::BinaryExpression*>(node);
+      this->resolve(e->left);
+      this->resolve(e->right);
+      break;
+    }
+    case ast::NodeType::Identifier: {
+      auto* identifier = static_cast<ast::Identifier*>(node);
+      auto& slot = this->slot_of_atom[identifier->name];
+      if (slot == ast::kNoSlot) {
+        slot = static_cast<uint32_t>(this->names.size());
+        this->names.push_back(identifier->name);
+      }
+      identifier->slot = slot;
+      break;
+    }
+    default:
+      break;
+    }
+  }
+};
+
+} // namespace
+
+std::vector<Atom> resolveSlots(ast::Program& program, const SymbolTable& symbols) {
+  LETTER_PROFILE_ZONE("resolveSlots");
+  _Resolver resolver;
+  resolver.slot_of_atom.assign(symbols.size(), ast::kNoSlot);
+  resolver.resolve(&program);
+  return std::move(resolver.names);
+}
+
+} // namespace letter
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Ast.h"
+#include "SymbolTable.h"
+
+#include <vector>
+
+namespace letter {
+
+/**
+ * @brief: give every variable of `program` a fixed slot, written into each `ast::Identifier`
+ * Blocks do not open a scope, so there is one slot per distinct name,
+ * numbered in the order of first appearance.
+ * @return: the name of each slot, indexed by slot
+ */
+std::vector<Atom> resolveSlots(ast::Program& program, const SymbolTable& symbols);
+
+} // namespace letter
@@ -0,0 +1,241 @@
+#include "Scan.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define LETTER_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace letter {
+
+const char* scanIsaName(ScanIsa isa) {
+  switch (isa) {
+  case ScanIsa::Scalar: return "scalar";
+  case ScanIsa::SSE2:   return "sse2";
+  case ScanIsa::AVX2:   return "avx2";
+  }
+  return "unknown";
+}
+
+/**
+ * @brief: same set as the regex `\s`: " \t\n\v\f\r"
+ */
+static inline bool _isSpace(unsigned char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// scalar kernels, also finish the tail shorter than a vector for the others
+
+static std::size_t _skipWhitespaceScalar(const char* s, std::size_t i, std::size_t size) {
+  while (i < size && _isSpace(s[i])) {
+    ++i;
+  }
+  return i;
+}
+
+static std::size_t _findCommentCloseScalar(const char* s, std::size_t i, std::size_t size) {
+  while (i + 1 < size) {
+    const void* star = std::memchr(s + i, '*', size - i - 1);
+    if (!star) {
+      break;
+    }
+    i = static_cast<const char*>(star) - s;
+    if (s[i + 1] == '/') {
+      return i;
+    }
+    ++i;
+  }
+  return size;
+}
+
+static std::size_t _findQuoteScalar(const char* s, std::size_t i, std::size_t size, char quote) {
+  while (i < size && s[i] != quote) {
+    ++i;
+  }
+  return i;
+}
+
+static std::size_t _findLineEndScalar(const char* s, std::size_t i, std::size_t size) {
+  while (i < size && s[i] != '\n' && s[i] != '\r') {
+    ++i;
+  }
+  return i;
+}
+
+#ifdef LETTER_SCAN_X86
+
+// SSE2 is part of x86-64, these need no check at run time
+
+static inline __m128i _spaceMask16(__m128i v) {
+  // c - '\t' <= '\r' - '\t' unsigned, as min(x, 4) == x
+  const __m128i x = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+  const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8('\r' - '\t')), x);
+  return _mm_or_si128(control, _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+}
+
+static std::size_t _skipWhitespaceSSE2(const char* s, std::size_t i, std::size_t size) {
+  for (; i + 16 <= size; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+    const unsigned other = ~static_cast<unsigned>(_mm_movemask_epi8(_spaceMask16(v))) & 0xFFFFu;
+    if (other) {
+      return i + __builtin_ctz(other);
+    }
+  }
+  return _skipWhitespaceScalar(s, i, size);
+}
+
+static std::size_t _findCommentCloseSSE2(const char* s, std::size_t i, std::size_t size) {
+  const __m128i star = _mm_set1_epi8('*');
+  const __m128i slash = _mm_set1_epi8('/');
+  // a "*" in this vector and a "/" in the one a byte further
+  for (; i + 17 <= size; i += 16) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 1));
+    const unsigned hits = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, star), _mm_cmpeq_epi8(b, slash)));
+    if (hits) {
+      return i + __builtin_ctz(hits);
+    }
+  }
+  return _findCommentCloseScalar(s, i, size);
+}
+
+static std::size_t _findQuoteSSE2(const char* s, std::size_t i, std::size_t size, char quote) {
+  const __m128i q = _mm_set1_epi8(quote);
+  for (; i + 16 <= size; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+    const unsigned hits = _mm_movemask_epi8(_mm_cmpeq_epi8(v, q));
+    if (hits) {
+      return i + __builtin_ctz(hits);
+    }
+  }
+  return _findQuoteScalar(s, i, size, quote);
+}
+
+static std::size_t _findLineEndSSE2(const char* s, std::size_t i, std::size_t size) {
+  const __m128i lf = _mm_set1_epi8('\n');
+  const __m128i cr = _mm_set1_epi8('\r');
+  for (; i + 16 <= size; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+    const unsigned hits = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+    if (hits) {
+      return i + __builtin_ctz(hits);
+    }
+  }
+  return _findLineEndScalar(s, i, size);
+}
+
+// AVX2 ones are compiled for AVX2 alone, and only called once the cpu says it has it
+
+#define LETTER_AVX2 __attribute__((target("avx2")))
+
+LETTER_AVX2 static std::size_t _skipWhitespaceAVX2(const char* s, std::size_t i, std::size_t size) {
+  for (; i + 32 <= size; i += 32) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    const __m256i x = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+    const __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8('\r' - '\t')), x);
+    const __m256i space = _mm256_or_si256(control, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+    const uint32_t other = ~static_cast<uint32_t>(_mm256_movemask_epi8(space));
+    if (other) {
+      return i + __builtin_ctz(other);
+    }
+  }
+  return _skipWhitespaceSSE2(s, i, size);
+}
+
+LETTER_AVX2 static std::size_t _findCommentCloseAVX2(const char* s, std::size_t i, std::size_t size) {
+  const __m256i star = _mm256_set1_epi8('*');
+  const __m256i slash = _mm256_set1_epi8('/');
+  for (; i + 33 <= size; i += 32) {
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + 1));
+    const uint32_t hits = _mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(a, star), _mm256_cmpeq_epi8(b, slash)));
+    if (hits) {
+      return i + __builtin_ctz(hits);
+    }
+  }
+  return _findCommentCloseSSE2(s, i, size);
+}
+
+LETTER_AVX2 static std::size_t _findQuoteAVX2(const char* s, std::size_t i, std::size_t size, char quote) {
+  const __m256i q = _mm256_set1_epi8(quote);
+  for (; i + 32 <= size; i += 32) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    const uint32_t hits = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, q));
+    if (hits) {
+      return i + __builtin_ctz(hits);
+    }
+  }
+  return _findQuoteSSE2(s, i, size, quote);
+}
+
+LETTER_AVX2 static std::size_t _findLineEndAVX2(const char* s, std::size_t i, std::size_t size) {
+  const __m256i lf = _mm256_set1_epi8('\n');
+  const __m256i cr = _mm256_set1_epi8('\r');
+  for (; i + 32 <= size; i += 32) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    const uint32_t hits = _mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr)));
+    if (hits) {
+      return i + __builtin_ctz(hits);
+    }
+  }
+  return _findLineEndSSE2(s, i, size);
+}
+
+#undef LETTER_AVX2
+
+#endif // LETTER_SCAN_X86
+
+static const ScanKernels s_scalar = {
+  ScanIsa::Scalar, _skipWhitespaceScalar, _findCommentCloseScalar, _findQuoteScalar, _findLineEndScalar,
+};
+
+#ifdef LETTER_SCAN_X86
+static const ScanKernels s_sse2 = {
+  ScanIsa::SSE2, _skipWhitespaceSSE2, _findCommentCloseSSE2, _findQuoteSSE2, _findLineEndSSE2,
+};
+
+static const ScanKernels s_avx2 = {
+  ScanIsa::AVX2, _skipWhitespaceAVX2, _findCommentCloseAVX2, _findQuoteAVX2, _findLineEndAVX2,
+};
+#endif
+
+bool scanIsaSupported(ScanIsa isa) {
+  switch (isa) {
+  case ScanIsa::Scalar:
+    return true;
+#ifdef LETTER_SCAN_X86
+  case ScanIsa::SSE2:
+    return true;
+  case ScanIsa::AVX2:
+    return __builtin_cpu_supports("avx2");
+#endif
+  default:
+    return false;
+  }
+}
+
+const ScanKernels& scanKernels(ScanIsa isa) {
+#ifdef LETTER_SCAN_X86
+  if (scanIsaSupported(isa)) {
+    switch (isa) {
+    case ScanIsa::SSE2: return s_sse2;
+    case ScanIsa::AVX2: return s_avx2;
+    default: break;
+    }
+  }
+#endif
+  (void)isa;
+  return s_scalar;
+}
+
+const ScanKernels& scanKernels() {
+  static const ScanKernels& s_best = 
+    scanIsaSupported(ScanIsa::AVX2) ? scanKernels(ScanIsa::AVX2) : scanKernels(ScanIsa::SSE2);
+  return s_best;
+}
+
+} // namespace letter
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+
+namespace letter {
+
+/**
+ * @brief: instruction set a scanning kernel is written for
+ */
+enum class ScanIsa {
+  Scalar,
+  SSE2,     // 16 bytes at a time
+  AVX2,     // 32 bytes at a time
+};
+
+const char* scanIsaName(ScanIsa isa);
+
+/**
+ * @brief: kernels which scan the long runs of bytes between tokens
+ * Each one takes the source `s` of `size` bytes and starts at `i`, it returns the offset
+ * of what it looks for, `size` if there is none. All of them give the same offsets,
+ * only their speed differs.
+ */
+struct ScanKernels {
+  ScanIsa isa;
+
+  // first byte which is not white space, same set as the regex `\s`
+  std::size_t (*skipWhitespace)(const char* s, std::size_t i, std::size_t size);
+
+  // the "*/" closing a documentation comment, the offset of its "*"
+  std::size_t (*findCommentClose)(const char* s, std::size_t i, std::size_t size);
+
+  // the byte `quote`, closing a string literal
+  std::size_t (*findQuote)(const char* s, std::size_t i, std::size_t size, char quote);
+
+  // the "\n" or "\r" ending a "//" comment
+  std::size_t (*findLineEnd)(const char* s, std::size_t i, std::size_t size);
+};
+
+/**
+ * @brief: whether this machine can run the kernels of `isa`
+ */
+bool scanIsaSupported(ScanIsa isa);
+
+/**
+ * @brief: the kernels of the widest instruction set this machine supports, picked once at run time
+ */
+const ScanKernels& scanKernels();
+
+/**
+ * @brief: the kernels of `isa`, the scalar ones if this machine can not run them
+ */
+const ScanKernels& scanKernels(ScanIsa isa);
+
+} // namespace letter
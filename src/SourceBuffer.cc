@@ -0,0 +1,172 @@
+#include "SourceBuffer.h"
+#include "Exception.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LETTER_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace letter {
+
+SourceBuffer::SourceBuffer()
+  : m_mapped(nullptr), m_mapped_size(0) {
+
+}
+
+SourceBuffer::~SourceBuffer() {
+  this->_release();
+}
+
+SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept
+  : m_string(std::move(other.m_string)), m_mapped(other.m_mapped), m_mapped_size(other.m_mapped_size) {
+  other.m_mapped = nullptr;
+  other.m_mapped_size = 0;
+}
+
+SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+  if (this != &other) {
+    this->_release();
+    this->m_string = std::move(other.m_string);
+    this->m_mapped = other.m_mapped;
+    this->m_mapped_size = other.m_mapped_size;
+    other.m_mapped = nullptr;
+    other.m_mapped_size = 0;
+  }
+  return *this;
+}
+
+void SourceBuffer::_release() {
+#ifdef LETTER_HAS_MMAP
+  if (this->m_mapped) {
+    ::munmap(const_cast<char*>(this->m_mapped), this->m_mapped_size);
+  }
+#endif
+  this->m_mapped = nullptr;
+  this->m_mapped_size = 0;
+  this->m_string.clear();
+}
+
+void SourceBuffer::replace(std::size_t offset, std::size_t removed, std::string_view inserted) {
+  if (this->m_mapped) {
+    std::string string(this->view());
+    this->_release();
+    this->m_string = std::move(string);
+  }
+  this->m_string.replace(offset, removed, inserted);
+}
+
+void SourceBuffer::releaseBefore(std::size_t offset) {
+#ifdef LETTER_HAS_MMAP
+  if (this->m_mapped) {
+    // the mapping starts on a page, only whole pages before `offset` go
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t length = std::min(offset, this->m_mapped_size) / page * page;
+    if (length) {
+      ::madvise(const_cast<char*>(this->m_mapped), length, MADV_DONTNEED);
+    }
+  }
+#else
+  (void)offset;
+#endif
+}
+
+void SourceBuffer::assign(std::string_view text) {
+  this->_release();
+  this->m_string.assign(text.data(), text.size());
+}
+
+SourceBuffer SourceBuffer::fromString(std::string string) {
+  SourceBuffer buffer;
+  buffer.m_string = std::move(string);
+  return buffer;
+}
+
+#ifdef LETTER_HAS_MMAP
+
+/**
+ * @brief: close the fd when leaving the scope
+ */
+struct _FdGuard {
+  int fd;
+  ~_FdGuard() { ::close(fd); }
+};
+
+static Exception _fileError(const std::string& what, const std::string& path) {
+  return Exception(what + " \"" + path + "\": " + std::strerror(errno));
+}
+
+SourceBuffer SourceBuffer::fromFile(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw _fileError("Cannot open file", path);
+  }
+  _FdGuard guard{fd};
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    throw _fileError("Cannot stat file", path);
+  }
+
+  SourceBuffer buffer;
+
+  if (S_ISREG(st.st_mode)) {
+    if (st.st_size == 0) {
+      return buffer; // nothing to map, an empty source
+    }
+
+    void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+      throw _fileError("Cannot map file", path);
+    }
+    // the tokenizer reads the source front to back exactly once
+    ::madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+    buffer.m_mapped = static_cast<const char*>(addr);
+    buffer.m_mapped_size = static_cast<std::size_t>(st.st_size);
+    return buffer;
+  }
+
+  // non-regular file (pipe, fifo, character device), can not be mapped, stream it in
+  char chunk[64 * 1024];
+  while (true) {
+    ssize_t n = ::read(fd, chunk, sizeof(chunk));
+    if (n == 0) {
+      break;
+    }
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw _fileError("Cannot read file", path);
+    }
+    buffer.m_string.append(chunk, static_cast<std::size_t>(n));
+  }
+  return buffer;
+}
+
+#else
+
+SourceBuffer SourceBuffer::fromFile(const std::string& path) {
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs.is_open()) {
+    throw Exception("Cannot open file \"" + path + "\"");
+  }
+
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+  return fromString(ss.str());
+}
+
+#endif
+
+} // namespace letter
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace letter {
+
+/**
+ * @brief: read only source text of a parse
+ * Either a private read-only mmap of a regular file, or an owned string
+ * (copied from memory, or streamed from a non-regular file such as a pipe).
+ * Move only, the mapping is released on destruction.
+ */
+class SourceBuffer {
+private:
+  std::string m_string;
+  const char* m_mapped;
+  std::size_t m_mapped_size;
+
+public:
+  SourceBuffer();
+  ~SourceBuffer();
+
+  SourceBuffer(SourceBuffer&& other) noexcept;
+  SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+
+  SourceBuffer(const SourceBuffer&) = delete;
+  SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+  /**
+   * @brief: own a copy of `string`
+   */
+  static SourceBuffer fromString(std::string string);
+
+  /**
+   * @brief: own a copy of `text` instead of the current source, in the owned string which keeps its capacity
+   * `text` must not view this buffer. Invalidates `view`.
+   */
+  void assign(std::string_view text);
+
+  /**
+   * @brief: map a regular file, or read a non-regular file (pipe, tty...) into a buffer
+   * throw `letter::Exception` if the file can not be opened or read
+   */
+  static SourceBuffer fromFile(const std::string& path);
+
+  inline std::string_view view() const {
+    return this->m_mapped ? std::string_view(this->m_mapped, this->m_mapped_size)
+      : std::string_view(this->m_string);
+  }
+
+  inline bool isMapped() const { return this->m_mapped != nullptr; }
+
+  /**
+   * @brief: replace `removed` bytes at `offset` by `inserted`, in place
+   * A mapped file is first copied into an owned string. Invalidates `view`.
+   */
+  void replace(std::size_t offset, std::size_t removed, std::string_view inserted);
+
+  /**
+   * @brief: give back the memory of a mapped file before `offset`, a no-op for a string
+   * The pages are read again from the file if touched later, `view` stays valid.
+   */
+  void releaseBefore(std::size_t offset);
+
+private:
+  void _release();
+};
+
+} // namespace letter
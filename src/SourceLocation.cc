@@ -0,0 +1,39 @@
+#include "SourceLocation.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+namespace letter {
+
+LineIndex::LineIndex() : m_starts{0} {
+
+}
+
+LineIndex::LineIndex(std::string_view source, const ScanKernels& scan/*= scanKernels()*/) {
+  this->build(source, scan);
+}
+
+void LineIndex::build(std::string_view source, const ScanKernels& scan/*= scanKernels()*/) {
+  LETTER_PROFILE_ZONE("LineIndex::build");
+  auto&& starts = this->m_starts;
+  starts.clear();
+  starts.push_back(0);
+
+  const char* s = source.data();
+  const std::size_t size = source.size();
+  std::size_t i = 0;
+  while ((i = scan.findLineEnd(s, i, size)) < size) {
+    if (s[i] == '\r' && i + 1 < size && s[i + 1] == '\n') {
+      ++ i;
+    }
+    starts.push_back(static_cast<uint32_t>(++ i));
+  }
+}
+
+SourcePosition LineIndex::position(uint32_t offset) const {
+  // the last line start at or before `offset`
+  auto it = std::upper_bound(this->m_starts.begin(), this->m_starts.end(), offset) - 1;
+  return {static_cast<uint32_t>(it - this->m_starts.begin()) + 1, offset - *it};
+}
+
+} // namespace letter
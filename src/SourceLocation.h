@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Scan.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace letter {
+
+/**
+ * @brief: byte range of a token or a node in its source
+ * 32 bits each, so sources over 4GB do not locate.
+ */
+struct SourceSpan {
+  uint32_t offset = 0;
+  uint32_t length = 0;
+
+  inline uint32_t end() const { return this->offset + this->length; }
+};
+
+/**
+ * @brief: line from 1, column from 0, counted in bytes
+ */
+struct SourcePosition {
+  uint32_t line;
+  uint32_t column;
+};
+
+/**
+ * @brief: offsets of the line starts of a source, to turn offsets into lines and columns
+ * Built in one pass with the `findLineEnd` kernel, "\n", "\r\n" and "\r" each end a line.
+ * A lookup is a binary search, nothing is counted while parsing.
+ */
+class LineIndex {
+private:
+  std::vector<uint32_t> m_starts; // m_starts[0] is 0
+
+public:
+  LineIndex();
+  explicit LineIndex(std::string_view source, const ScanKernels& scan = scanKernels());
+
+  /**
+   * @brief: index `source` again, the storage is kept
+   */
+  void build(std::string_view source, const ScanKernels& scan = scanKernels());
+
+  SourcePosition position(uint32_t offset) const;
+
+  inline std::size_t lines() const { return this->m_starts.size(); }
+};
+
+} // namespace letter
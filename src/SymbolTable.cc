@@ -0,0 +1,87 @@
+#include "SymbolTable.h"
+
+#include <algorithm>
+
+namespace letter {
+
+SymbolTable::SymbolTable()
+  : m_intern_count(0), m_interned_bytes(0) {
+
+}
+
+/**
+ * @brief: 32 bit FNV-1a
+ */
+uint32_t SymbolTable::_hash(std::string_view str) {
+  uint32_t hash = 2166136261u;
+  for (unsigned char c : str) {
+    hash ^= c;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+Atom SymbolTable::intern(std::string_view str) {
+  ++this->m_intern_count;
+  this->m_interned_bytes += str.size();
+
+  // keep the load factor under 1/2
+  if ((this->m_entries.size() + 1) * 2 > this->m_slots.size()) {
+    this->_rehash(std::max<std::size_t>(64, this->m_slots.size() * 2));
+  }
+
+  const uint32_t hash = _hash(str);
+  const std::size_t mask = this->m_slots.size() - 1;
+
+  for (std::size_t i = hash & mask; ; i = (i + 1) & mask) {
+    Atom atom = this->m_slots[i];
+    if (atom == kNoAtom) {
+      atom = static_cast<Atom>(this->m_entries.size());
+      this->m_entries.push_back(Entry{
+        static_cast<uint32_t>(this->m_chars.size()), static_cast<uint32_t>(str.size()), hash});
+      this->m_chars.append(str.data(), str.size());
+      this->m_slots[i] = atom;
+      return atom;
+    }
+
+    auto&& entry = this->m_entries[atom];
+    if (entry.hash == hash && this->name(atom) == str) {
+      return atom;
+    }
+  }
+}
+
+void SymbolTable::_rehash(std::size_t slot_count) {
+  this->m_slots.assign(slot_count, kNoAtom);
+  const std::size_t mask = slot_count - 1;
+
+  for (Atom atom = 0; atom < this->m_entries.size(); ++atom) {
+    std::size_t i = this->m_entries[atom].hash & mask;
+    while (this->m_slots[i] != kNoAtom) {
+      i = (i + 1) & mask;
+    }
+    this->m_slots[i] = atom;
+  }
+}
+
+void SymbolTable::clear() {
+  this->m_chars.clear();
+  this->m_entries.clear();
+  std::fill(this->m_slots.begin(), this->m_slots.end(), kNoAtom);
+  this->m_intern_count = 0;
+  this->m_interned_bytes = 0;
+}
+
+SymbolTable::Stats SymbolTable::stats() const {
+  Stats stats;
+  stats.unique_atoms = this->m_entries.size();
+  stats.occurrences = this->m_intern_count;
+  stats.interned_bytes = this->m_interned_bytes;
+  stats.stored_bytes = this->m_chars.size();
+  stats.table_bytes = this->m_chars.capacity() +
+    this->m_entries.capacity() * sizeof(Entry) +
+    this->m_slots.capacity() * sizeof(Atom);
+  return stats;
+}
+
+} // namespace letter
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace letter {
+
+/**
+ * @brief: compact integer standing for an interned string
+ */
+using Atom = uint32_t;
+
+constexpr Atom kNoAtom = UINT32_MAX;
+
+/**
+ * @brief: interning table of identifier names and string literal contents
+ * Every distinct string is stored once in a contiguous char buffer, and is
+ * handed out as a dense `Atom` (0, 1, 2...), so equal names compare as integers.
+ * `clear` drops the strings but keeps the capacity for the next parse.
+ */
+class SymbolTable {
+private:
+  struct Entry {
+    uint32_t offset;  // into m_chars
+    uint32_t length;
+    uint32_t hash;
+  };
+
+  std::string m_chars;
+  std::vector<Entry> m_entries;   // indexed by atom
+  std::vector<Atom> m_slots;      // open addressing, kNoAtom if empty
+
+  std::size_t m_intern_count;     // calls of `intern`
+  std::size_t m_interned_bytes;   // bytes passed to `intern`
+
+public:
+  SymbolTable();
+
+  /**
+   * @brief: the atom of `str`, added to the table if it is not there yet
+   */
+  Atom intern(std::string_view str);
+
+  /**
+   * @brief: the string of `atom`, invalidated by the next `intern`
+   */
+  inline std::string_view name(Atom atom) const {
+    auto&& entry = this->m_entries[atom];
+    return std::string_view(this->m_chars.data() + entry.offset, entry.length);
+  }
+
+  inline std::size_t size() const { return this->m_entries.size(); }
+
+  void clear();
+
+  /**
+   * @brief: statistics, over all `intern` calls since the last `clear`
+   */
+  struct Stats {
+    std::size_t unique_atoms;     // distinct strings
+    std::size_t occurrences;      // `intern` calls
+    std::size_t interned_bytes;   // bytes of all the occurrences
+    std::size_t stored_bytes;     // bytes actually stored, one copy per distinct string
+    std::size_t table_bytes;      // memory held by the table itself
+  };
+
+  Stats stats() const;
+
+private:
+  static uint32_t _hash(std::string_view str);
+  void _rehash(std::size_t slot_count);
+};
+
+} // namespace letter
@@ -0,0 +1,38 @@
+#include "Token.h"
+
+#include <string>
+
+namespace letter {
+
+const char* tokenTypeName(TokenKind kind) {
+  switch (kind) {
+  case TokenKind::EndOfFile:              return "EOF";
+  case TokenKind::Semicolon:              return ";";
+  case TokenKind::LeftBrace:              return "{";
+  case TokenKind::RightBrace:             return "}";
+  case TokenKind::LeftParen:              return "(";
+  case TokenKind::RightParen:             return ")";
+  case TokenKind::Number:                 return "NUMBER";
+  case TokenKind::String:                 return "STRING";
+  case TokenKind::Identifier:             return "IDENTIRIFER";
+  case TokenKind::SimpleAssign:           return "SIMPLE_ASSIGN";
+  case TokenKind::ComplexAssign:          return "COMPLEX_ASSIGN";
+  case TokenKind::AdditiveOperator:       return "ADDITIVE_OPERATOR";
+  case TokenKind::MultiplicativeOperator: return "MULTIPLICATIVE_OPERATOR";
+  case TokenKind::Invalid:                return "INVALID";
+  }
+  return "UNKNOWN";
+}
+
+json::value toJson(const Token& token) {
+  if (token.empty()) {
+    return {};
+  }
+
+  return json::object{
+    {"type", tokenTypeName(token.kind)},
+    {"value", std::string(token.value)}
+  };
+}
+
+} // namespace letter
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "json.hpp"
+#include "Number.h"
+#include "SourceLocation.h"
+#include "SymbolTable.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+namespace letter {
+
+/**
+ * @brief: kind of a token, integer comparable
+ * the comment of each kind is its type name in the json token form
+ */
+enum class TokenKind : uint8_t {
+  EndOfFile,                // no more tokens, the empty json token
+  Semicolon,                // ";"
+  LeftBrace,                // "{"
+  RightBrace,               // "}"
+  LeftParen,                // "("
+  RightParen,               // ")"
+  Number,                   // "NUMBER"
+  String,                   // "STRING"
+  Identifier,               // "IDENTIRIFER"
+  SimpleAssign,             // "SIMPLE_ASSIGN"
+  ComplexAssign,            // "COMPLEX_ASSIGN"
+  AdditiveOperator,         // "ADDITIVE_OPERATOR"
+  MultiplicativeOperator,   // "MULTIPLICATIVE_OPERATOR"
+  Invalid,                  // "INVALID", text no rule matches, only in diagnostics mode (see `Tokenizer::setDiagnostics`)
+};
+
+/**
+ * @brief: binding power of an operator token, the one table of `Parser` and `EventParser`
+ * precedence 0 means the token is not a binary or assignment operator.
+ * Adding an operator is adding its row to `_operatorInfo`, it adds no grammar method and no recursion level.
+ */
+struct OperatorInfo {
+  uint8_t precedence;
+  bool right_associative;
+  bool assignment;
+};
+
+constexpr OperatorInfo _operatorInfo(TokenKind kind) {
+  switch (kind) {
+  case TokenKind::SimpleAssign:           return {1, true, true};
+  case TokenKind::ComplexAssign:          return {1, true, true};
+  case TokenKind::AdditiveOperator:       return {2, false, false};
+  case TokenKind::MultiplicativeOperator: return {3, false, false};
+  default:                                return {0, false, false};
+  }
+}
+
+template <std::size_t... I>
+constexpr std::array<OperatorInfo, sizeof...(I)> _makeOperatorTable(std::index_sequence<I...>) {
+  return {{_operatorInfo(static_cast<TokenKind>(I))...}};
+}
+
+inline constexpr auto kOperatorTable = 
+  _makeOperatorTable(std::make_index_sequence<static_cast<std::size_t>(TokenKind::Invalid) + 1>{});
+
+inline constexpr const OperatorInfo& operatorInfo(TokenKind kind) {
+  return kOperatorTable[static_cast<std::size_t>(kind)];
+}
+
+/**
+ * @brief: a token is a kind plus a view of its text in the source buffer
+ * It does not own any memory, and stays valid as long as the source does.
+ * Identifiers and strings also carry their atom if the tokenizer interns them,
+ * the atom of a string is the one of its contents without the quotes.
+ * `offset` is where the text starts in the tokenized source, the source size for `EndOfFile`.
+ * A number carries its value, converted by the tokenizer.
+ */
+struct Token {
+  TokenKind kind = TokenKind::EndOfFile;
+  std::string_view value;
+  Atom atom = kNoAtom;
+  uint32_t offset = 0;
+  NumberValue number;
+
+  Token() = default;
+
+  /**
+   * @brief: a token of `kind` over `value`, the tokenizer sets the rest
+   */
+  Token(TokenKind kind, std::string_view value) : kind(kind), value(value) {}
+
+  inline bool empty() const { return this->kind == TokenKind::EndOfFile; }
+
+  inline SourceSpan span() const { return {this->offset, static_cast<uint32_t>(this->value.size())}; }
+};
+
+/**
+ * @brief: type name of the kind, as used by the json token form
+ */
+const char* tokenTypeName(TokenKind kind);
+
+/**
+ * @brief: compatibility shim, convert to the json form {"type": ..., "value": ...}
+ * `TokenKind::EndOfFile` converts to the empty json value
+ */
+json::value toJson(const Token& token);
+
+} // namespace letter
@@ -1,29 +1,41 @@
 #include "Tokenizer.h"
 #include "Exception.h"
+#include "Instrument.h"
+#include "Profiler.h"
 #include "ElapsedTimer.h"
 
-#include "json.hpp"
-
 #include <regex>
 #include <iostream>
 #include <vector>
 #include <optional>
 #include <map>
+#include <algorithm>
+#include <cstring>
+#include <array>
+#include <cstdint>
 
 namespace letter {
 
 Tokenizer::Tokenizer() 
-  : m_cursor(0) {
+  : m_cursor(0), m_engine(Engine::Scanner), m_symbols(nullptr), m_scan(&scanKernels()), m_diagnostics(nullptr) {
 
 }
 
-Tokenizer::Tokenizer(const std::string& string) 
-  : m_string(string), m_cursor(0) {
+Tokenizer::Tokenizer(const std::string& string, Engine engine/*= Engine::Scanner*/) 
+  : m_string(string), m_source(m_string), m_cursor(0), m_engine(engine), m_symbols(nullptr),
+    m_scan(&scanKernels()), m_diagnostics(nullptr) {
 
 }
 
 void Tokenizer::init(const std::string& string) {
   this->m_string = string;
+  this->m_source = this->m_string;
+  this->m_cursor = 0;
+}
+
+void Tokenizer::initView(std::string_view source) {
+  this->m_string.clear();
+  this->m_source = source;
   this->m_cursor = 0;
 }
 
@@ -31,143 +43,447 @@ void Tokenizer::init(const std::string& string) {
  * @brief: vector of the spec table
  * if type == std::nullopt, means just skip this pattern if matched
  */
-static const std::vector<std::pair<std::regex, Tokenizer::TokenType>> s_spec_vec = {
-  {std::regex{R"(^;)"}, ";"},                       // ;
-  {std::regex{R"(^\s+)"}, std::nullopt},            // white space
-  {std::regex{R"(^\d+)"}, "NUMBER"},                // numbers
-  {std::regex{R"(^\"[^\"]*\")"}, "STRING"},            // string with double quote
-  {std::regex{R"(^\'[^\']*\')"}, "STRING"},            // string with single quote
-  {std::regex{R"(^\/\/.*)"}, std::nullopt},           // comments start with "//"
-  {std::regex{R"(^\/\*[\s\S]*?\*\/)"}, std::nullopt},   // documentation comment "/* */"
-  {std::regex{R"(^\{)"}, "{"},
-  {std::regex{R"(^\})"}, "}"},
-
-  {std::regex{R"(^\w+)"}, "IDENTIRIFER"},           // this must be after "NUMBER", since \w+ include numbers
-  {std::regex{R"(^=)"}, "SIMPLE_ASSIGN"},
-  {std::regex{R"(^[\*\/\+\-]=)"}, "COMPLEX_ASSIGN"}, // this must be before "+/-"
-
-  {std::regex{R"(^[\+\-])"}, "ADDITIVE_OPERATOR"},
-  {std::regex{R"(^[\*\/])"}, "MULTIPLICATIVE_OPERATOR"},
-  {std::regex{R"(^\()"}, "("},
-  {std::regex{R"(^\))"}, ")"},
+static const std::vector<std::pair<std::regex, std::optional<TokenKind>>> s_spec_vec = {
+  {std::regex{R"(^;)"}, TokenKind::Semicolon},                  // ;
+  {std::regex{R"(^\s+)"}, std::nullopt},                        // white space
+  {std::regex{R"(^0[xX][0-9a-fA-F]+)"}, TokenKind::Number},      // hex numbers
+  {std::regex{R"(^\d+(\.\d+)?([eE][+-]?\d+)?)"}, TokenKind::Number}, // numbers, with a fraction or an exponent
+  {std::regex{R"(^\"[^\"]*\")"}, TokenKind::String},             // string with double quote
+  {std::regex{R"(^\'[^\']*\')"}, TokenKind::String},             // string with single quote
+  {std::regex{R"(^\/\/.*)"}, std::nullopt},                      // comments start with "//"
+  {std::regex{R"(^\/\*[\s\S]*?\*\/)"}, std::nullopt},              // documentation comment "/* */"
+  {std::regex{R"(^\{)"}, TokenKind::LeftBrace},
+  {std::regex{R"(^\})"}, TokenKind::RightBrace},
+
+  {std::regex{R"(^\w+)"}, TokenKind::Identifier},               // this must be after "NUMBER", since \w+ include numbers
+  {std::regex{R"(^=)"}, TokenKind::SimpleAssign},
+  {std::regex{R"(^[\*\/\+\-]=)"}, TokenKind::ComplexAssign},     // this must be before "+/-"
+
+  {std::regex{R"(^[\+\-])"}, TokenKind::AdditiveOperator},
+  {std::regex{R"(^[\*\/])"}, TokenKind::MultiplicativeOperator},
+  {std::regex{R"(^\()"}, TokenKind::LeftParen},
+  {std::regex{R"(^\))"}, TokenKind::RightParen},
 };
 
 /**
- * @brief: Try to match(search) regex pattern `regexp` in str
- * @return: matched result if matched, `std::nullopt` if not matched
+ * @brief: Try to match regex pattern `regexp` in place, anchored at `begin`
+ * @return: length of the match if matched, `std::nullopt` if not matched
  */
-static Tokenizer::TokenType 
-_match(const std::regex& regexp, const std::string& str) {
-  // std::cout << "_match cur str: \"" << str << "\"" << std::endl;
-  // ElapsedTimer t("match timer");
-  std::smatch m;
-  if (std::regex_search(str.begin(), str.end(), m, regexp)) {
-    return m[0].str();
+static std::optional<std::size_t> 
+_match(const std::regex& regexp, const char* begin, const char* end) {
+  LETTER_PROFILE_ZONE("Tokenizer::_match");
+  std::cmatch m;
+  // match_continuous: only try at `begin`, never search forward through the rest of input
+  if (std::regex_search(begin, end, m, regexp, std::regex_constants::match_continuous)) {
+    return static_cast<std::size_t>(m.length(0));
   } else {
     return std::nullopt;
   }
 }
 
-json::value Tokenizer::getNextToken() {
-  if (!this->hasMoreTokens()) {
-    // std::cout << "[DEBUG] has no more tokens!" << std::endl;
-    return {};
+Token Tokenizer::getNextToken() {
+  instrument::PhaseScope phase(instrument::Phase::Tokenize);
+  LETTER_PROFILE_ZONE("Tokenizer::getNextToken");
+  auto token = this->m_engine == Engine::Regex ? this->_regexToken() : this->_scanToken();
+  token.offset = static_cast<uint32_t>(token.empty() ? this->m_source.size() : token.value.data() - this->m_source.data());
+  if (token.kind == TokenKind::Number) {
+    token.number = parseNumber(token.value);
+  }
+  return this->_intern(token);
+}
+
+Token Tokenizer::_intern(Token token) {
+  if (!this->m_symbols) {
+    return token;
+  }
+
+  if (token.kind == TokenKind::Identifier) {
+    token.atom = this->m_symbols->intern(token.value);
+  } else if (token.kind == TokenKind::String) {
+    token.atom = this->m_symbols->intern(token.value.substr(1, token.value.size() - 2));
+  }
+  return token;
+}
+
+/**
+ * @brief: kind of the single char tokens ; { } ( )
+ */
+static inline TokenKind _punctuatorKind(unsigned char c) {
+  switch (c) {
+  case ';': return TokenKind::Semicolon;
+  case '{': return TokenKind::LeftBrace;
+  case '}': return TokenKind::RightBrace;
+  case '(': return TokenKind::LeftParen;
+  default:  return TokenKind::RightParen;
   }
-  
-  const auto str = this->m_string.substr(this->m_cursor);
+}
+
+/**
+ * @brief: same class as the regex `\w`: [A-Za-z0-9_]
+ */
+static inline bool _isWordChar(unsigned char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || 
+    (c >= '0' && c <= '9') || c == '_';
+}
 
-  for (auto&& [regexp, token_type_opt] : s_spec_vec) {
-    auto&& token_value_opt = _match(regexp, str);
-    if (!token_value_opt) {
-      // if value is nullopt, means does not match
-      continue; // continue trying to match next regex pattern
+static inline bool _isDigit(unsigned char c) {
+  return c >= '0' && c <= '9';
+}
+
+static inline bool _isHexDigit(unsigned char c) {
+  return _isDigit(c) || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f');
+}
+
+/**
+ * @brief: end of the number starting with the digit at `start`
+ * Same as the regexes `0[xX][0-9a-fA-F]+` then `\d+(\.\d+)?([eE][+-]?\d+)?`: a fraction or an exponent
+ * without digits is not part of the number, "1.x" is the number "1" followed by ".x".
+ */
+static std::size_t _scanNumber(const char* s, std::size_t start, std::size_t size) {
+  if (s[start] == '0' && start + 2 < size && (s[start + 1] | 0x20) == 'x' && _isHexDigit(s[start + 2])) {
+    std::size_t i = start + 3;
+    while (i < size && _isHexDigit(s[i])) {
+      ++i;
+    }
+    return i;
+  }
+
+  std::size_t i = start + 1;
+  while (i < size && _isDigit(s[i])) {
+    ++i;
+  }
+  if (i + 1 < size && s[i] == '.' && _isDigit(s[i + 1])) {
+    i += 2;
+    while (i < size && _isDigit(s[i])) {
+      ++i;
+    }
+  }
+  if (i + 1 < size && (s[i] | 0x20) == 'e') {
+    std::size_t j = i + 1;
+    if (s[j] == '+' || s[j] == '-') {
+      ++j;
+    }
+    if (j < size && _isDigit(s[j])) {
+      i = j + 1;
+      while (i < size && _isDigit(s[i])) {
+        ++i;
+      }
+    }
+  }
+  return i;
+}
+
+/**
+ * @brief: hand-written scanner, recognizes one token by switching on its first byte
+ * Produces exactly the same tokens as the regex spec table `s_spec_vec`,
+ * including the order in which overlapping rules take priority.
+ */
+Token Tokenizer::_scanToken() {
+  const char* s = this->m_source.data();
+  const std::size_t size = this->m_source.size();
+
+  while (this->m_cursor < size) {
+    const std::size_t start = this->m_cursor;
+    const unsigned char c = s[start];
+
+    switch (c) {
+    case ';': case '{': case '}': case '(': case ')':
+      ++this->m_cursor;
+      return {_punctuatorKind(c), {s + start, 1}};
+
+    // white space, same set as `\s`
+    case ' ': case '\t': case '\n': case '\v': case '\f': case '\r': {
+      std::size_t i = start + 1;
+      // a lone space is the common case, only runs are worth a kernel
+      if (i < size && (s[i] == ' ' || (s[i] >= '\t' && s[i] <= '\r'))) {
+        i = this->m_scan->skipWhitespace(s, i + 1, size);
+      }
+      this->m_cursor = i;
+      continue; // skip, find next token
+    }
+
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9': {
+      std::size_t i = _scanNumber(s, start, size);
+      this->m_cursor = i;
+      return {TokenKind::Number, {s + start, i - start}};
     }
-    
-    // matched
-    
-    // std::cout << "type:" 
-    //   << token_type_opt.value_or("null_type") << std::endl;
 
-    // std::cout << "value:["
-    //   << token_value_opt.value() << "]" << std::endl;
+    case '"': case '\'': {
+      const std::size_t close = this->m_scan->findQuote(s, start + 1, size, c);
+      if (close == size) {
+        // unterminated string, no rule matches the quote
+        if (this->m_diagnostics) {
+          return this->_invalid(start, this->m_scan->findLineEnd(s, start + 1, size));
+        }
+        throw Exception("Unexpected token: \"" + std::string(1, c) + "\"");
+      }
+      this->m_cursor = close + 1;
+      return {TokenKind::String, {s + start, this->m_cursor - start}};
+    }
+
+    case '/': 
+      if (start + 1 < size && s[start + 1] == '/') {
+        // comments start with "//", until the end of line
+        this->m_cursor = this->m_scan->findLineEnd(s, start + 2, size);
+        continue;
+      }
+      if (start + 1 < size && s[start + 1] == '*') {
+        // documentation comment "/* */", an unterminated one is just a '/' operator
+        const std::size_t close = this->m_scan->findCommentClose(s, start + 2, size);
+        if (close != size) {
+          this->m_cursor = close + 2;
+          continue;
+        }
+      }
+      [[fallthrough]];
+    case '*': case '+': case '-':
+      if (start + 1 < size && s[start + 1] == '=') {
+        this->m_cursor += 2;
+        return {TokenKind::ComplexAssign, {s + start, 2}};
+      }
+      ++this->m_cursor;
+      return {(c == '+' || c == '-') ? TokenKind::AdditiveOperator : TokenKind::MultiplicativeOperator,
+          {s + start, 1}};
+
+    case '=':
+      ++this->m_cursor;
+      return {TokenKind::SimpleAssign, {s + start, 1}};
+
+    default:
+      if (_isWordChar(c)) {
+        std::size_t i = start + 1;
+        while (i < size && _isWordChar(s[i])) {
+          ++i;
+        }
+        this->m_cursor = i;
+        return {TokenKind::Identifier, {s + start, i - start}};
+      }
+      if (this->m_diagnostics) {
+        return this->_invalid(start, start + 1);
+      }
+      throw Exception("Unexpected token: \"" + std::string(1, c) + "\"");
+    }
+  }
+
+  return {};
+}
+
+/**
+ * @brief: reference engine, tries every pattern of the spec table in order
+ * Matches in place at the cursor, and skips white space and comments in a loop.
+ */
+Token Tokenizer::_regexToken() {
+  const char* s = this->m_source.data();
+  const char* end = s + this->m_source.size();
+
+  while (this->hasMoreTokens()) {
+    const std::size_t start = this->m_cursor;
+    std::optional<std::size_t> length;
+    std::optional<TokenKind> kind;
 
-    // assert whether it is the first few chars
-    auto&& value = token_value_opt.value();
-    if (value != str.substr(0, value.size())) {
-      throw Exception("Unexpected failure. str:" + str + ", value:" + value);
+    for (auto&& [regexp, token_kind_opt] : s_spec_vec) {
+      length = _match(regexp, s + start, end);
+      if (length) {
+        kind = token_kind_opt;
+        break;
+      }
+      // if length is nullopt, means does not match
+      // continue trying to match next regex pattern
+    }
+
+    if (!length) {
+      if (this->m_diagnostics) {
+        const bool quote = s[start] == '"' || s[start] == '\'';
+        return this->_invalid(start, quote ? this->m_scan->findLineEnd(s, start + 1, end - s) : start + 1);
+      }
+      // After trying all the regex match, still not match, then throw
+      throw Exception("Unexpected token: \"" + std::string(s + start, 1) + "\"");
     }
 
     // increase the cursor, to point to the next possible token start
-    this->m_cursor += value.size();
+    this->m_cursor += length.value();
 
-    if (!token_type_opt) {
-      // if matched, but token type is null, means to skip this token
+    if (!kind) {
+      // if matched, but token kind is null, means to skip this token
       // such as: whitespace, comments etc.
-      return this->getNextToken(); // skip this, find next token
+      continue;
     }
     
-    return json::object{
-      {"type", token_type_opt.value()}, 
-      {"value", token_value_opt.value()}
-    };
-  }
-  
-  // After trying all the regex match, still not match, then throw
-  throw Exception("Unexpected token: \"" + str.substr(0, 1) + "\"");
-
-  /*
-  // Numbers:
-  std::smatch m;
-  if (std::regex_search(str.begin(), str.end(), m, std::regex(R"(^\d+)"))) {
-    this->m_cursor += m[0].length();
-    // std::cout << m[0].str() << std::endl;
-    return json::object{
-      {"type", "NUMBER"},
-      {"value", m[0].str()}
-    };
-  }
-  // if (std::isdigit(this->m_string[m_cursor])) {
-  //   std::string number;
-  //   while (std::isdigit(this->m_string[this->m_cursor])) {
-  //     number += this->m_string[this->m_cursor++];
-  //   }
-
-  //   return json::object{
-  //     {"type", "NUMBER"},
-  //     {"value", number}
-  //   };
-  // }
-
-  // String: "..."
-  if (std::regex_search(str.begin(), str.end(), m, std::regex(R"("[^"]*")"))) {
-    this->m_cursor += m[0].length();
-    return json::object{
-      {"type", "STRING"},
-      {"value", m[0].str()}
-    };
-  }
-  
-  // String: '...'
-  if (std::regex_search(str.begin(), str.end(), m, std::regex(R"('[^']*')"))) {
-    this->m_cursor += m[0].length();
-    return json::object{
-      {"type", "STRING"},
-      {"value", m[0].str()}
-    };
-  }
-
-  // if (this->m_string[0] == '\"') {
-  //   std::string s;
-  //   while ( this->m_string[++this->m_cursor] != '\"' && !this->isEOF() ) {
-  //     s += this->m_string[this->m_cursor];
-  //   }
-  //   return json::object{
-  //     {"type", "STRING"},
-  //     {"value", s}
-  //   };
-  // }
-  */
+    return {kind.value(), this->m_source.substr(start, length.value())};
+  }
+
+  // std::cout << "[DEBUG] has no more tokens!" << std::endl;
+  return {};
+}
+
+/**
+ * @brief: diagnostics mode, record the text [start, end) which no rule matches, and go on after it
+ */
+Token Tokenizer::_invalid(std::size_t start, std::size_t end) {
+  this->m_diagnostics->add({DiagnosticKind::InvalidCharacter, TokenKind::EndOfFile, start, end - start, nullptr});
+  this->m_cursor = end;
+  return {TokenKind::Invalid, this->m_source.substr(start, end - start)};
+}
 
+/**
+ * @brief: class of a byte for `splitTopLevel`: 0 part of a token, 1 white space, 2 needs a look
+ */
+static constexpr std::array<uint8_t, 256> _makeSplitClasses() {
+  std::array<uint8_t, 256> classes{};
+  for (unsigned char c : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+    classes[c] = 1;
+  }
+  for (unsigned char c : {'"', '\'', '/', '{', '}', ';'}) {
+    classes[c] = 2;
+  }
+  return classes;
+}
+
+static constexpr auto s_split_classes = _makeSplitClasses();
+
+std::vector<std::size_t> splitTopLevel(std::string_view source, std::size_t part_size) {
+  const char* s = source.data();
+  const std::size_t size = source.size();
+
+  std::vector<std::size_t> cuts;
+  std::size_t depth = 0;
+  std::size_t next_cut = std::max<std::size_t>(part_size, 1);
+  std::size_t last_token = 0;         // the last byte of a token seen so far
+  bool comments_can_close = true;     // a "/*" without "*/" after it means no later one has any
+  const ScanKernels& scan = scanKernels();
+
+  auto&& boundary = [&](std::size_t end) {
+    if (depth == 0 && end >= next_cut) {
+      cuts.push_back(end);
+      next_cut = end + std::max<std::size_t>(part_size, 1);
+    }
+  };
+
+  std::size_t i = 0;
+  while (i < size) {
+    const unsigned char c = s[i];
+    switch (s_split_classes[c]) {
+    case 0:
+      last_token = i++;
+      continue;
+    case 1:
+      ++i;
+      if (i < size && s_split_classes[static_cast<unsigned char>(s[i])] == 1) {
+        i = scan.skipWhitespace(s, i + 1, size);
+      }
+      continue;
+    }
+
+    switch (c) {
+    case '"': case '\'': {
+      const std::size_t close = scan.findQuote(s, i + 1, size, static_cast<char>(c));
+      last_token = i;
+      if (close == size) {
+        i = size; // the tokenizer throws here
+        break;
+      }
+      i = close + 1;
+      last_token = close;
+      break;
+    }
+    case '/':
+      if (i + 1 < size && s[i + 1] == '/') {
+        i = scan.findLineEnd(s, i + 2, size);
+        break;
+      }
+      if (i + 1 < size && s[i + 1] == '*' && comments_can_close) {
+        const std::size_t close = scan.findCommentClose(s, i + 2, size);
+        if (close != size) {
+          i = close + 2;
+          break;
+        }
+        comments_can_close = false;
+      }
+      last_token = i++;
+      break;
+    case '{':
+      last_token = i++;
+      ++depth;
+      break;
+    case '}':
+      last_token = i++;
+      if (depth == 0) {
+        i = size; // closes nothing, the parser throws here
+        break;
+      }
+      --depth;
+      boundary(i);
+      break;
+    default: // ';'
+      last_token = i++;
+      boundary(i);
+      break;
+    }
+  }
+
+  // a part made of trivia alone has no statement
+  while (!cuts.empty() && cuts.back() > last_token) {
+    cuts.pop_back();
+  }
+  return cuts;
+}
+
+std::size_t findBlockClose(std::string_view source, std::size_t open) {
+  const char* s = source.data();
+  const std::size_t size = source.size();
+  const ScanKernels& scan = scanKernels();
+  std::size_t depth = 1;
+  bool comments_can_close = true; // as in `splitTopLevel`
+
+  std::size_t i = open + 1;
+  while (i < size) {
+    const unsigned char c = s[i];
+    if (s_split_classes[c] != 2) {
+      ++i;
+      continue;
+    }
+
+    switch (c) {
+    case '"': case '\'': {
+      const std::size_t close = scan.findQuote(s, i + 1, size, static_cast<char>(c));
+      if (close == size) {
+        return size;
+      }
+      i = close + 1;
+      break;
+    }
+    case '/':
+      if (i + 1 < size && s[i + 1] == '/') {
+        i = scan.findLineEnd(s, i + 2, size);
+        break;
+      }
+      if (i + 1 < size && s[i + 1] == '*' && comments_can_close) {
+        const std::size_t close = scan.findCommentClose(s, i + 2, size);
+        if (close != size) {
+          i = close + 2;
+          break;
+        }
+        comments_can_close = false;
+      }
+      ++i;
+      break;
+    case '{':
+      ++depth;
+      ++i;
+      break;
+    case '}':
+      if (--depth == 0) {
+        return i;
+      }
+      ++i;
+      break;
+    default: // ';'
+      ++i;
+      break;
+    }
+  }
+  return size;
 }
 
 }
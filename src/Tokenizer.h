@@ -1,33 +1,118 @@
 #pragma once
 
-#include "json.hpp"
+#include "Diagnostic.h"
+#include "Scan.h"
+#include "Token.h"
+#include "SymbolTable.h"
+
 #include <cstddef>
 #include <string>
+#include <string_view>
 #include <optional>
+#include <vector>
 
 
 namespace letter {
 
 class Tokenizer {
+public:
+  /**
+   * @brief: the engine used to recognize tokens
+   * Scanner: hand-written state machine, switches on the first byte (default)
+   * Regex: walks the regex spec table, kept as the reference implementation
+   */
+  enum class Engine {
+    Scanner,
+    Regex,
+  };
+
 private:
-  std::string m_string; 
+  std::string m_string;   // owned copy, only used by `init`
+  std::string_view m_source;
   std::size_t m_cursor;
+  Engine m_engine;
+  SymbolTable* m_symbols;
+  const ScanKernels* m_scan;  // skip trivia and find the ends of literals
+  Diagnostics* m_diagnostics; // diagnostics mode if not nullptr
 
 public:
-  using TokenType = std::optional<std::string>;
+  Tokenizer(const std::string& string, Engine engine = Engine::Scanner);
 
-  Tokenizer(const std::string& string);
-  
   Tokenizer();
-  
+
+  // `m_source` may view `m_string`, copying would leave it dangling
+  Tokenizer(const Tokenizer&) = delete;
+  Tokenizer& operator=(const Tokenizer&) = delete;
+
+  /**
+   * @brief: tokenize a copy of `string`
+   */
   void init(const std::string& string);
 
-  inline bool hasMoreTokens() { return this->m_cursor < this->m_string.size(); }
+  /**
+   * @brief: tokenize `source` in place, without copying
+   * the caller keeps `source` alive (e.g. a mapped `SourceBuffer`) while tokenizing
+   */
+  void initView(std::string_view source);
+
+  /**
+   * @brief: go on tokenizing at `offset` of the source, which must not be inside a token
+   */
+  inline void seek(std::size_t offset) { this->m_cursor = offset; }
+
+  inline void setEngine(Engine engine) { this->m_engine = engine; }
+
+  inline Engine engine() const { return this->m_engine; }
 
-  inline bool isEOF() const { return this->m_cursor == this->m_string.size(); }
+  /**
+   * @brief: scan trivia and literals with the kernels of `isa`, the widest supported one by default
+   */
+  inline void setScanIsa(ScanIsa isa) { this->m_scan = &scanKernels(isa); }
 
-  json::value getNextToken(); 
+  /**
+   * @brief: intern identifiers and string contents into `symbols`, nullptr to stop
+   */
+  inline void setSymbolTable(SymbolTable* symbols) { this->m_symbols = symbols; }
 
+  /**
+   * @brief: record invalid text into `diagnostics` instead of throwing, nullptr to stop
+   * The invalid text comes back as a `TokenKind::Invalid` token: a stray char,
+   * or an unclosed string up to the end of its line.
+   */
+  inline void setDiagnostics(Diagnostics* diagnostics) { this->m_diagnostics = diagnostics; }
+
+  inline bool hasMoreTokens() { return this->m_cursor < this->m_source.size(); }
+
+  inline bool isEOF() const { return this->m_cursor == this->m_source.size(); }
+
+  /**
+   * @brief: the next token, `TokenKind::EndOfFile` if no more tokens
+   * The token views the source buffer, it is invalidated by `init`.
+   */
+  Token getNextToken();
+
+private:
+  Token _intern(Token token);
+  Token _scanToken();
+  Token _regexToken();
+  Token _invalid(std::size_t start, std::size_t end);
 };
 
+/**
+ * @brief: offsets where `source` can be cut between two top-level statements, one about every `part_size` bytes
+ * A cut follows a ";" or a "}" back at brace depth 0, outside strings and comments, exactly as the
+ * tokenizer sees them, and a token follows it. If every part parses on its own, the parts give
+ * the statements of the whole source, in order. Cutting stops at anything the tokenizer or the
+ * parser would reject on the way (an unterminated string, a "}" closing nothing).
+ */
+std::vector<std::size_t> splitTopLevel(std::string_view source, std::size_t part_size);
+
+/**
+ * @brief: offset of the "}" matching the "{" at `open`, `source.size()` if there is none
+ * Braces are matched outside strings and comments, as the tokenizer sees them, without tokenizing.
+ * No match means the tokenizer or the parser would reject the text on the way (an unterminated string,
+ * an unclosed block).
+ */
+std::size_t findBlockClose(std::string_view source, std::size_t open);
+
 }; // namespace letter
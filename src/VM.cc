@@ -0,0 +1,131 @@
+#include "VM.h"
+#include "Exception.h"
+#include "Profiler.h"
+
+#include <string>
+
+namespace letter {
+
+VM::VM(const Chunk& chunk)
+  : m_chunk(chunk), m_slots(chunk.slot_names.size()), m_stack(chunk.max_stack + 1) {
+
+}
+
+std::optional<uint32_t> VM::slotOf(std::string_view name) const {
+  for (uint32_t slot = 0; slot < this->m_chunk.slot_names.size(); ++slot) {
+    if (this->m_chunk.slot_names[slot] == name) {
+      return slot;
+    }
+  }
+  return std::nullopt;
+}
+
+bool VM::setVariable(std::string_view name, Value value) {
+  auto&& slot = this->slotOf(name);
+  if (!slot) {
+    return false;
+  }
+  this->m_slots[*slot] = std::move(value);
+  return true;
+}
+
+Value VM::variable(std::string_view name) const {
+  auto&& slot = this->slotOf(name);
+  return slot ? this->m_slots[*slot] : Value{};
+}
+
+#if LETTER_VM_COMPUTED_GOTO
+#define VM_CASE(op) L_##op:
+#define VM_NEXT() goto *s_labels[*ip++]
+#else
+#define VM_CASE(op) case OpCode::op:
+#define VM_NEXT() break
+#endif
+
+/**
+ * @brief: arithmetic instruction, numbers inline, everything else through `binaryOperation`
+ */
+#define VM_ARITHMETIC(op, expr)                                         \
+  VM_CASE(op) {                                                         \
+    Value& l = sp[-2];                                                  \
+    const Value& r = sp[-1];                                            \
+    if (l.isNumber() && r.isNumber()) {                                 \
+      double a = l.asNumber();                                          \
+      double b = r.asNumber();                                          \
+      l = (expr);                                                       \
+    } else {                                                            \
+      l = binaryOperation(ast::Operator::op, l, r);                     \
+    }                                                                   \
+    --sp;                                                               \
+    VM_NEXT();                                                          \
+  }
+
+Value VM::run() {
+  LETTER_PROFILE_ZONE("VM::run");
+  const uint8_t* ip = this->m_chunk.code.data();
+  const Value* constants = this->m_chunk.constants.data();
+  Value* slots = this->m_slots.data();
+  Value* sp = this->m_stack.data(); // next free entry
+
+  Value completion;
+
+#if LETTER_VM_COMPUTED_GOTO
+  // same order as `OpCode`
+  static const void* s_labels[] = {
+    &&L_Constant, &&L_Load, &&L_Store, 
+    &&L_Add, &&L_Sub, &&L_Mul, &&L_Div, 
+    &&L_Complete, &&L_Return,
+  };
+  VM_NEXT();
+#else
+  for (;;) {
+    switch (static_cast<OpCode>(*ip++)) {
+#endif
+
+  VM_CASE(Constant) {
+    *sp++ = constants[readOperand(ip)];
+    ip += 4;
+    VM_NEXT();
+  }
+
+  VM_CASE(Load) {
+    uint32_t slot = readOperand(ip);
+    ip += 4;
+    if (slots[slot].isUndefined()) {
+      throw Exception(this->m_chunk.slot_names[slot] + " is not defined");
+    }
+    *sp++ = slots[slot];
+    VM_NEXT();
+  }
+
+  VM_CASE(Store) {
+    slots[readOperand(ip)] = sp[-1];
+    ip += 4;
+    VM_NEXT();
+  }
+
+  VM_ARITHMETIC(Add, a + b)
+  VM_ARITHMETIC(Sub, a - b)
+  VM_ARITHMETIC(Mul, a * b)
+  VM_ARITHMETIC(Div, a / b)
+
+  VM_CASE(Complete) {
+    completion = std::move(*--sp);
+    VM_NEXT();
+  }
+
+  VM_CASE(Return) {
+    return completion;
+  }
+
+#if !LETTER_VM_COMPUTED_GOTO
+    }
+  }
+#endif
+}
+
+#undef VM_ARITHMETIC
+#undef VM_NEXT
+#undef VM_CASE
+
+} // namespace letter
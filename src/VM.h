@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Bytecode.h"
+#include "Value.h"
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// computed goto dispatch where the compiler supports it, a switch loop otherwise
+#if !defined(LETTER_VM_COMPUTED_GOTO)
+#if defined(__GNUC__) || defined(__clang__)
+#define LETTER_VM_COMPUTED_GOTO 1
+#else
+#define LETTER_VM_COMPUTED_GOTO 0
+#endif
+#endif
+
+namespace letter {
+
+/**
+ * @brief: stack machine running a compiled `Chunk`
+ * Compile once, then `run` as many times as needed, changing the inputs with `setVariable`
+ * between runs. Variable values are kept between runs. The chunk must outlive the VM.
+ */
+class VM {
+private:
+  const Chunk& m_chunk;
+  std::vector<Value> m_slots;
+  std::vector<Value> m_stack;
+
+public:
+  explicit VM(const Chunk& chunk);
+
+  /**
+   * @brief: execute the chunk
+   * @return: completion value, the value of the last expression statement executed
+   * throw `letter::Exception` on runtime errors, e.g. reading an unassigned variable
+   */
+  Value run();
+
+  /**
+   * @brief: slot of the variable `name`, std::nullopt if the program does not use it
+   */
+  std::optional<uint32_t> slotOf(std::string_view name) const;
+
+  inline Value& slot(uint32_t slot) { return this->m_slots[slot]; }
+
+  /**
+   * @brief: set a variable by name, e.g. an input of the script
+   * @return: false if the program does not use `name`
+   */
+  bool setVariable(std::string_view name, Value value);
+
+  /**
+   * @brief: value of a variable by name, undefined if unknown or never assigned
+   */
+  Value variable(std::string_view name) const;
+};
+
+} // namespace letter
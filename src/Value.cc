@@ -0,0 +1,89 @@
+#include "Value.h"
+#include "Exception.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+
+namespace letter {
+
+static std::string _numberToString(double number) {
+  if (std::isnan(number)) {
+    return "NaN";
+  }
+  if (std::isinf(number)) {
+    return number > 0 ? "Infinity" : "-Infinity";
+  }
+  // integers print without a fraction, as long as a double holds them exactly
+  if (number == std::trunc(number) && std::fabs(number) < 9007199254740992.0) {
+    return std::to_string(static_cast<int64_t>(number));
+  }
+
+  char buffer[32];
+  auto&& [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), number);
+  return std::string(buffer, end);
+}
+
+std::string Value::toString() const {
+  if (this->isNumber()) {
+    return _numberToString(this->asNumber());
+  } else if (this->isString()) {
+    return this->asString();
+  }
+  return "undefined";
+}
+
+const char* Value::typeName() const {
+  if (this->isNumber()) {
+    return "number";
+  } else if (this->isString()) {
+    return "string";
+  }
+  return "undefined";
+}
+
+bool Value::operator==(const Value& other) const {
+  if (this->m_data.index() != other.m_data.index()) {
+    return false;
+  }
+  if (this->isNumber()) {
+    return this->asNumber() == other.asNumber();
+  } else if (this->isString()) {
+    return this->asString() == other.asString();
+  }
+  return true;
+}
+
+ast::Operator arithmeticOperator(ast::Operator op) {
+  switch (op) {
+  case ast::Operator::AddAssign: return ast::Operator::Add;
+  case ast::Operator::SubAssign: return ast::Operator::Sub;
+  case ast::Operator::MulAssign: return ast::Operator::Mul;
+  case ast::Operator::DivAssign: return ast::Operator::Div;
+  default:                       return op;
+  }
+}
+
+Value binaryOperation(ast::Operator op, const Value& left, const Value& right) {
+  op = arithmeticOperator(op);
+
+  if (left.isNumber() && right.isNumber()) {
+    double l = left.asNumber();
+    double r = right.asNumber();
+    switch (op) {
+    case ast::Operator::Add: return l + r;
+    case ast::Operator::Sub: return l - r;
+    case ast::Operator::Mul: return l * r;
+    case ast::Operator::Div: return l / r;
+    default: break;
+    }
+  } else if (op == ast::Operator::Add && (left.isString() || right.isString()) &&
+      !left.isUndefined() && !right.isUndefined()) {
+    return left.toString() + right.toString();
+  }
+
+  throw Exception(std::string("Unsupported operand types for ") + ast::operatorText(op) +
+      ": " + left.typeName() + " and " + right.typeName());
+}
+
+} // namespace letter
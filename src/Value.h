@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Ast.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <variant>
+
+namespace letter {
+
+/**
+ * @brief: runtime value of the evaluators: undefined, a number or a string
+ * Numbers are doubles. Strings are immutable and shared, copying a value never copies the text.
+ */
+class Value {
+private:
+  std::variant<std::monostate, double, std::shared_ptr<const std::string>> m_data;
+
+public:
+  Value() = default;
+  Value(double number) : m_data(number) {}
+  Value(std::string string) : m_data(std::make_shared<const std::string>(std::move(string))) {}
+  Value(std::string_view string) : Value(std::string(string)) {}
+  Value(const char* string) : Value(std::string(string)) {}
+
+  inline bool isUndefined() const { return this->m_data.index() == 0; }
+  inline bool isNumber() const { return this->m_data.index() == 1; }
+  inline bool isString() const { return this->m_data.index() == 2; }
+
+  inline double asNumber() const { return std::get<1>(this->m_data); }
+  inline const std::string& asString() const { return *std::get<2>(this->m_data); }
+
+  /**
+   * @brief: "undefined", the number (integers without fraction) or the string itself
+   */
+  std::string toString() const;
+
+  /**
+   * @brief: name of the type, as used in error messages
+   */
+  const char* typeName() const;
+
+  bool operator==(const Value& other) const;
+  inline bool operator!=(const Value& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief: apply a binary operator (or the operator of a compound assignment, e.g. `+=` as `+`)
+ * `+` concatenates as soon as one side is a string, the others only take numbers.
+ * throw `letter::Exception` on unsupported operand types
+ */
+Value binaryOperation(ast::Operator op, const Value& left, const Value& right);
+
+/**
+ * @brief: `+` for `+=` etc., `op` itself for the binary operators
+ */
+ast::Operator arithmeticOperator(ast::Operator op);
+
+} // namespace letter
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace letter {
+
+/**
+ * @brief: build a deterministic program of about `size` bytes,
+ * which touches every token class
+ */
+inline std::string generate_program(std::size_t size, uint32_t seed = 20231017) {
+  static const char* const s_snippets[] = {
+    "x = 42;\n",
+    "total += price * 3 - discount / 2;\n",
+    "  // a line comment\n",
+    "/* a documentation\n   comment */\n",
+    "\"double quoted\";\n",
+    "'single quoted';\n",
+    "{ y1 = (a + b) * c; ; }\n",
+    "count -= 1;\t\n",
+  };
+  constexpr std::size_t n = sizeof(s_snippets) / sizeof(s_snippets[0]);
+
+  std::mt19937 rng(seed);
+  std::string program;
+  program.reserve(size + 64);
+  while (program.size() < size) {
+    program += s_snippets[rng() % n];
+  }
+  return program;
+}
+
+/**
+ * @brief: build a deterministic program of about `size` bytes, where
+ * `unique_names` identifiers and as many strings repeat over and over
+ */
+inline std::string generate_names_program(std::size_t size, std::size_t unique_names = 300, 
+    uint32_t seed = 20231017) {
+  std::mt19937 rng(seed);
+  auto&& name = [&]() { return "name_" + std::to_string(rng() % unique_names); };
+
+  std::string program;
+  program.reserve(size + 128);
+  while (program.size() < size) {
+    switch (rng() % 4) {
+    case 0:  program += name() + " = " + name() + " + " + name() + " * 2;\n"; break;
+    case 1:  program += name() + " += " + name() + ";\n"; break;
+    case 2:  program += "'text of " + name() + "';\n"; break;
+    default: program += "{ " + name() + " = " + name() + " - 1; }\n"; break;
+    }
+  }
+  return program;
+}
+
+/**
+ * @brief: build a deterministic program of about `size` bytes which can be evaluated:
+ * `variables` variables are assigned first, then only updated with + - * /
+ * The first `inputs` variables are left unassigned, the caller sets them before running.
+ */
+inline std::string generate_eval_program(std::size_t size, std::size_t variables = 64, 
+    std::size_t inputs = 0, uint32_t seed = 20231017) {
+  std::mt19937 rng(seed);
+  auto&& name = [&]() { return "v" + std::to_string(rng() % variables); };
+
+  std::string program;
+  program.reserve(size + 128);
+  for (std::size_t i = inputs; i < variables; ++i) {
+    program += "v" + std::to_string(i) + " = " + std::to_string(i + 1) + ";\n";
+  }
+  program += "s = 'text';\n";
+
+  while (program.size() < size) {
+    switch (rng() % 6) {
+    case 0:  program += name() + " = " + name() + " + " + name() + " * 2;\n"; break;
+    case 1:  program += name() + " += " + std::to_string(rng() % 100) + ";\n"; break;
+    case 2:  program += name() + " = (" + name() + " - 3) / 7;\n"; break;
+    case 3:  program += "{ " + name() + " *= 1; " + name() + " -= 1; }\n"; break;
+    case 4:  program += "s = 'x' + 'y';\n"; break;
+    default: program += name() + " - " + name() + ";\n"; break;
+    }
+  }
+  return program;
+}
+
+/**
+ * @brief: build a deterministic program of about `size` bytes of blocks nested `depth` deep,
+ * with a few statements at every level
+ */
+inline std::string generate_nested_program(std::size_t size, std::size_t depth = 64, uint32_t seed = 20231017) {
+  std::mt19937 rng(seed);
+  std::string program;
+  program.reserve(size + depth * 32);
+  while (program.size() < size) {
+    for (std::size_t level = 0; level < depth; ++level) {
+      program += "{ n" + std::to_string(rng() % 100) + " = " + std::to_string(level) + "; ";
+    }
+    program += "; ";
+    for (std::size_t level = 0; level < depth; ++level) {
+      program += "}";
+    }
+    program += "\n";
+  }
+  return program;
+}
+
+/**
+ * @brief: build a deterministic program of about `size` bytes of expressions chaining
+ * `length` operands with + - * /, and a parenthesized group now and then
+ */
+inline std::string generate_chain_program(std::size_t size, std::size_t length = 256, uint32_t seed = 20231017) {
+  static const char* const s_operators[] = {" + ", " - ", " * ", " / "};
+  std::mt19937 rng(seed);
+  std::string program;
+  program.reserve(size + length * 16);
+  while (program.size() < size) {
+    program += "r = a0";
+    for (std::size_t i = 1; i < length; ++i) {
+      program += s_operators[rng() % 4];
+      if (rng() % 8 == 0) {
+        program += "(b" + std::to_string(i) + " + " + std::to_string(rng() % 1000) + ")";
+      } else {
+        program += "a" + std::to_string(rng() % 64);
+      }
+    }
+    program += ";\n";
+  }
+  return program;
+}
+
+/**
+ * @brief: build a deterministic program of about `size` bytes, mostly line and documentation comments
+ * of up to `comment_size` bytes, between short statements
+ */
+inline std::string generate_comment_program(std::size_t size, std::size_t comment_size = 2048, 
+    uint32_t seed = 20231017) {
+  std::mt19937 rng(seed);
+  std::string program;
+  program.reserve(size + comment_size * 2);
+  while (program.size() < size) {
+    const std::size_t length = 1 + rng() % comment_size;
+    if (rng() % 2) {
+      program += "/* " + std::string(length, 'c');
+      for (std::size_t i = program.size() - length; i < program.size(); i += 61) {
+        program[i] = "\n*/"[rng() % 3]; // lone "*" and "/", 61 bytes apart, never a "*/"
+      }
+      program += " */\n";
+    } else {
+      program += "// " + std::string(length, 'l') + "\n";
+    }
+    program += "x = x + 1;\n";
+  }
+  return program;
+}
+
+/**
+ * @brief: build a deterministic program of about `size` bytes of string literals
+ * of up to `string_size` bytes, in both quotes, added to each other
+ */
+inline std::string generate_string_program(std::size_t size, std::size_t string_size = 1024, 
+    uint32_t seed = 20231017) {
+  std::mt19937 rng(seed);
+  auto&& literal = [&]() {
+    std::string contents(1 + rng() % string_size, 's');
+    for (std::size_t i = 0; i < contents.size(); i += 7) {
+      contents[i] = " ;{}/*"[rng() % 6]; // punctuation a scanner must not take for tokens
+    }
+    return rng() % 2 ? "'" + contents + "'" : "\"" + contents + "\"";
+  };
+
+  std::string program;
+  program.reserve(size + string_size * 4);
+  while (program.size() < size) {
+    program += "s = " + literal() + " + " + literal() + ";\n";
+  }
+  return program;
+}
+
+/**
+ * @brief: build a deterministic program of about `size` bytes, one statement per line,
+ * where one line in `error_every` has a syntax error, as in a buffer being edited
+ */
+inline std::string generate_broken_program(std::size_t size, std::size_t error_every = 4, 
+    uint32_t seed = 20231017) {
+  static const char* const s_errors[] = {
+    "x = ;\n",
+    "total += price * ;\n",
+    "y = (a + b;\n",
+    "1 = z;\n",
+    "w = 2 $ 3;\n",
+    "s = 'text' + ;\n",
+    "{ u = ; v; }\n",
+    "a b;\n",
+  };
+  constexpr std::size_t n = sizeof(s_errors) / sizeof(s_errors[0]);
+
+  std::mt19937 rng(seed);
+  auto&& name = [&]() { return "v" + std::to_string(rng() % 256); };
+
+  std::string program;
+  program.reserve(size + 64);
+  while (program.size() < size) {
+    if (rng() % error_every == 0) {
+      program += s_errors[rng() % n];
+    } else {
+      program += name() + " = " + name() + " + " + std::to_string(rng() % 1000) + ";\n";
+    }
+  }
+  return program;
+}
+
+/**
+ * @brief: build a deterministic program of about `size` bytes made of numeric constants,
+ * as generated data scripts are: small and large integers, hex, fractions and exponents
+ */
+inline std::string generate_number_program(std::size_t size, uint32_t seed = 20231017) {
+  std::mt19937_64 rng(seed);
+  std::string program;
+  program.reserve(size + 128);
+  char hex[24];
+  for (std::size_t i = 0; program.size() < size; ++i) {
+    program += "v" + std::to_string(i % 1000) + " = ";
+    switch (rng() % 5) {
+    case 0:  program += std::to_string(rng() % 1000); break;
+    case 1:  program += std::to_string(rng() >> 2); break;
+    case 2:
+      std::snprintf(hex, sizeof(hex), "0x%llX", static_cast<unsigned long long>(rng() >> 4));
+      program += hex;
+      break;
+    case 3:  program += std::to_string(rng() % 100000) + "." + std::to_string(rng() % 1000000); break;
+    default: program += std::to_string(rng() % 10) + "." + std::to_string(rng() % 1000) + "e-" + 
+      std::to_string(rng() % 300); break;
+    }
+    program += " + " + std::to_string(rng() % 100) + ";\n";
+  }
+  return program;
+}
+
+/**
+ * @brief: build a deterministic program of about `size` bytes of top-level assignments, each followed
+ * by a block of about `block_size` bytes, with nested blocks, strings and comments holding braces
+ */
+inline std::string generate_block_program(std::size_t size, std::size_t block_size = 16 * 1024, 
+    uint32_t seed = 20231017) {
+  static const char* const s_statements[] = {
+    "  total += price * 3 - discount / 2;\n",
+    "  { y1 = (a + b) * c; ; }\n",
+    "  s = 'a } in a string';\n",
+    "  // a } in a comment\n",
+    "  /* a { in a\n     comment */\n",
+    "  { { n = n + 1; } }\n",
+  };
+  constexpr std::size_t n = sizeof(s_statements) / sizeof(s_statements[0]);
+
+  std::mt19937 rng(seed);
+  std::string program;
+  program.reserve(size + block_size + 64);
+  for (std::size_t i = 0; program.size() < size; ++i) {
+    program += "f" + std::to_string(i) + " = " + std::to_string(i) + ";\n{\n";
+    const std::size_t end = program.size() + block_size;
+    while (program.size() < end) {
+      program += s_statements[rng() % n];
+    }
+    program += "}\n";
+  }
+  return program;
+}
+
+/**
+ * @brief: build `count` deterministic one-line sources of `min_size` to `max_size` bytes,
+ * as an editor, a rule engine or a query front-end sends them one by one
+ */
+inline std::vector<std::string> generate_snippets(std::size_t count, std::size_t min_size = 10, 
+    std::size_t max_size = 100, uint32_t seed = 20231017) {
+  static const char* const s_statements[] = {
+    "x = 42;",
+    "y += x * 2;",
+    "total = (a + b) * c;",
+    "'single quoted';",
+    "n = n - 1; // tick",
+    "{ a = b / 4; }",
+    "v1 = 0x1F + 2.5e3;",
+    "name = \"value\";",
+    ";",
+  };
+  constexpr std::size_t n = sizeof(s_statements) / sizeof(s_statements[0]);
+
+  std::mt19937 rng(seed);
+  std::vector<std::string> snippets(count);
+  for (auto&& snippet : snippets) {
+    const std::size_t target = min_size + rng() % (max_size - min_size + 1);
+    while (snippet.size() < target) {
+      const std::string statement = s_statements[rng() % n];
+      if (snippet.size() + statement.size() + 1 > max_size) {
+        break;
+      }
+      snippet += snippet.empty() ? statement : " " + statement;
+    }
+  }
+  return snippets;
+}
+
+} // namespace letter
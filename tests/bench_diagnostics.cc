@@ -0,0 +1,77 @@
+#include "Diagnostic.h"
+#include "ElapsedTimer.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1024 * 1024;
+  std::size_t error_every = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+  int repeat = argc > 3 ? std::atoi(argv[3]) : 5;
+
+  auto&& program = letter::generate_broken_program(size, error_every);
+  std::cout << "input size: " << program.size() << "(bytes), an error every " << error_every
+    << " lines" << std::endl;
+
+  letter::Parser parser;
+  letter::Diagnostics diagnostics(1 << 20);
+  std::size_t statements = 0;
+  uint64_t best = UINT64_MAX;
+  for (int i = 0; i < repeat; ++i) {
+    letter::ElapsedTimer<std::chrono::microseconds> t("diagnostics mode", false);
+    statements = parser.parseAst(program, diagnostics)->body.size;
+    best = std::min<uint64_t>(best, t.elapsed());
+  }
+  std::cout << "diagnostics mode, one pass: " << best << "(microseconds), " << diagnostics.size()
+    << " errors, " << statements << " statements kept" << std::endl;
+
+  // what a lint can do with the throwing parse: one parse per line, each error unwinds
+  std::vector<std::string> lines;
+  for (std::size_t start = 0, end; start < program.size(); start = end + 1) {
+    end = program.find('\n', start);
+    end = end == std::string::npos ? program.size() : end;
+    lines.emplace_back(program, start, end - start);
+  }
+
+  std::size_t errors = 0;
+  best = UINT64_MAX;
+  for (int i = 0; i < repeat; ++i) {
+    letter::ElapsedTimer<std::chrono::microseconds> t("throwing parse per line", false);
+    errors = 0;
+    for (auto&& line : lines) {
+      try {
+        parser.parseAst(line);
+      } catch (const std::exception&) {
+        ++ errors;
+      }
+    }
+    best = std::min<uint64_t>(best, t.elapsed());
+  }
+  std::cout << "throwing parse per line: " << best << "(microseconds), " << errors << " errors" << std::endl;
+
+  // the cost of the mode on a valid program
+  auto&& valid = letter::generate_program(size);
+  uint64_t plain = UINT64_MAX, diagnosing = UINT64_MAX;
+  for (int i = 0; i < repeat; ++i) {
+    {
+      letter::ElapsedTimer<std::chrono::microseconds> t("plain parse", false);
+      parser.parseAst(valid);
+      plain = std::min<uint64_t>(plain, t.elapsed());
+    }
+    {
+      letter::ElapsedTimer<std::chrono::microseconds> t("diagnostics mode", false);
+      parser.parseAst(valid, diagnostics);
+      diagnosing = std::min<uint64_t>(diagnosing, t.elapsed());
+    }
+  }
+  std::cout << "valid program: plain parse " << plain << "(microseconds), diagnostics mode "
+    << diagnosing << "(microseconds)" << std::endl;
+
+  return diagnostics.empty() ? 0 : 1;
+}
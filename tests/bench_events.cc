@@ -0,0 +1,127 @@
+#include "ElapsedTimer.h"
+#include "EventParser.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * @brief: what our pipelines do with a parse: count statements, collect identifiers
+ */
+struct Counts {
+  std::size_t statements = 0;
+  std::size_t identifiers = 0;
+  std::size_t assignments = 0;
+};
+
+class CountingVisitor : public letter::ParseVisitor {
+public:
+  Counts counts;
+
+  void onStatementBegin(letter::ast::NodeType) override { ++this->counts.statements; }
+  void onIdentifier(std::string_view) override { ++this->counts.identifiers; }
+  void onAssignmentExpression(letter::ast::Operator) override { ++this->counts.assignments; }
+};
+
+static void count_tree(const letter::ast::Node* node, Counts& counts) {
+  using namespace letter::ast;
+  switch (node->type) {
+  case NodeType::Program:
+    for (auto* statement : static_cast<const Program*>(node)->body) {
+      count_tree(statement, counts);
+    }
+    break;
+  case NodeType::BlockStatement:
+    ++counts.statements;
+    for (auto* statement : static_cast<const BlockStatement*>(node)->body) {
+      count_tree(statement, counts);
+    }
+    break;
+  case NodeType::EmptyStatement:
+    ++counts.statements;
+    break;
+  case NodeType::ExpressionStatement:
+    ++counts.statements;
+    count_tree(static_cast<const ExpressionStatement*>(node)->expression, counts);
+    break;
+  case NodeType::AssignmentExpression:
+    ++counts.assignments;
+    count_tree(static_cast<const AssignmentExpression*>(node)->left, counts);
+    count_tree(static_cast<const AssignmentExpression*>(node)->right, counts);
+    break;
+  case NodeType::BinaryExpression:
+    count_tree(static_cast<const BinaryExpression*>(node)->left, counts);
+    count_tree(static_cast<const BinaryExpression*>(node)->right, counts);
+    break;
+  case NodeType::Identifier:
+    ++counts.identifiers;
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief: run `parse` in a child process, so each mode gets its own peak RSS
+ */
+static void run(const char* name, std::size_t bytes, const std::function<Counts()>& parse) {
+  std::cout.flush();
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    letter::ElapsedTimer<std::chrono::milliseconds> t(name, false);
+    auto&& counts = parse();
+    auto ms = std::max<uint64_t>(t.elapsed(), 1);
+    std::cout << name << ": " << ms << "(milliseconds), " << bytes / 1024.0 / 1024.0 / (ms / 1e3) << " MB/s, "
+      << counts.statements << " statements, " << counts.identifiers << " identifiers, " 
+      << counts.assignments << " assignments" << std::endl;
+    std::_Exit(0);
+  }
+
+  int status = 0;
+  struct rusage usage;
+  ::wait4(pid, &status, 0, &usage);
+  std::cout << name << ": peak RSS " << usage.ru_maxrss / 1024.0 << "(MB)"
+    << (WIFEXITED(status) && WEXITSTATUS(status) == 0 ? "" : " (failed)") << std::endl;
+}
+
+int main(int argc, char** argv) {
+  std::size_t mb = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 500;
+  std::string path = argc > 2 ? argv[2] : "/tmp/letter_bench_events.lt";
+
+  // written a megabyte at a time, the generator never holds the whole source
+  {
+    std::ofstream ofs(path, std::ios::binary);
+    for (std::size_t i = 0; i < mb; ++i) {
+      ofs << letter::generate_program(1024 * 1024, static_cast<uint32_t>(i));
+    }
+  }
+  std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+  const std::size_t bytes = static_cast<std::size_t>(ifs.tellg());
+  std::cout << "source: " << path << ", " << bytes << "(bytes)" << std::endl;
+
+  run("events", bytes, [&]() {
+    letter::EventParser parser;
+    CountingVisitor visitor;
+    parser.parseFile(path, visitor);
+    return visitor.counts;
+  });
+
+  run("ast   ", bytes, [&]() {
+    letter::Parser parser;
+    Counts counts;
+    count_tree(parser.parseFileAst(path), counts);
+    return counts;
+  });
+
+  std::remove(path.c_str());
+  return 0;
+}
@@ -0,0 +1,38 @@
+#include "ElapsedTimer.h"
+#include "Interpreter.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4 * 1024 * 1024;
+  int runs = argc > 2 ? std::atoi(argv[2]) : 5;
+  auto&& program = letter::generate_eval_program(size);
+
+  std::cout << "input size: " << program.size() << "(bytes)" << std::endl;
+
+  letter::Parser parser;
+  auto* ast = parser.parseAst(program);
+
+  letter::ElapsedTimer t("resolve", false);
+  letter::Interpreter interpreter(*ast, parser.symbols());
+  std::cout << "resolve slots: " << interpreter.slotCount() << " slots in " 
+    << t.elapsed() << "(microseconds)" << std::endl;
+
+  for (int i = 0; i < runs; ++i) {
+    std::size_t before = interpreter.statementsExecuted();
+    t.reset();
+    auto&& completion = interpreter.run();
+    auto us = t.elapsed();
+    std::size_t statements = interpreter.statementsExecuted() - before;
+
+    std::cout << "run " << i << ": " << statements << " statements in " << us << "(microseconds), "
+      << static_cast<uint64_t>(statements / (us > 0 ? us / 1e6 : 1e-6)) << " statements/s"
+      << ", completion: " << completion.toString() << std::endl;
+  }
+
+  return 0;
+}
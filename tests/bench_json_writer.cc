@@ -0,0 +1,64 @@
+#include "Ast.h"
+#include "ElapsedTimer.h"
+#include "JsonWriter.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+
+/**
+ * @brief: peak resident memory of the process so far, in MB
+ */
+static double peak_mb() {
+  struct rusage usage;
+  ::getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss / 1024.0;
+}
+
+int main(int argc, char** argv) {
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 8 * 1024 * 1024;
+  const char* path = argc > 2 ? argv[2] : "/dev/null";
+
+  auto&& program = letter::generate_program(size);
+  std::cout << "input size: " << program.size() << "(bytes), output to " << path << std::endl;
+
+  letter::Parser parser;
+  auto* ast = parser.parseAst(program);
+  const double parsed_mb = peak_mb();
+  std::cout << "peak memory after the parse: " << parsed_mb << "(MB)" << std::endl;
+
+  // streamed first: the peak only grows, whatever comes after can not hide it
+  for (bool pretty : {false, true}) {
+    int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      std::cout << "cannot open " << path << std::endl;
+      return 1;
+    }
+    letter::ElapsedTimer<std::chrono::microseconds> t("stream", false);
+    letter::JsonWriter writer(fd, pretty);
+    writer.writeAst(*ast, parser.symbols());
+    writer.flush();
+    auto us = t.elapsed();
+    ::close(fd);
+    std::cout << "stream, " << (pretty ? "pretty" : "compact") << ": " << writer.written() << "(bytes) in " << us
+      << "(microseconds), " << writer.written() / 1024.0 / 1024.0 / (us / 1e6) << " MB/s, peak memory +"
+      << peak_mb() - parsed_mb << "(MB)" << std::endl;
+  }
+
+  for (bool pretty : {false, true}) {
+    letter::ElapsedTimer<std::chrono::microseconds> t("json::value", false);
+    auto&& text = pretty ? letter::ast::toJson(*ast, parser.symbols()).format()
+      : letter::ast::toJson(*ast, parser.symbols()).to_string();
+    auto us = t.elapsed();
+    std::cout << "json::value, " << (pretty ? "format" : "to_string") << ": " << text.size() << "(bytes) in " << us
+      << "(microseconds), " << text.size() / 1024.0 / 1024.0 / (us / 1e6) << " MB/s, peak memory +"
+      << peak_mb() - parsed_mb << "(MB)" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,62 @@
+#include "Ast.h"
+#include "ElapsedTimer.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16 * 1024 * 1024;
+  std::size_t block_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16 * 1024;
+  int repeat = argc > 3 ? std::atoi(argv[3]) : 5;
+
+  auto&& program = letter::generate_block_program(size, block_size);
+  std::cout << "input size: " << program.size() << "(bytes), blocks of " << block_size << "(bytes)" << std::endl;
+
+  letter::Parser eager;
+  letter::Parser lazy;
+  lazy.setLazyBlocks(true);
+
+  // the first result is the top level: how many statements, and the first one
+  uint64_t eager_first = UINT64_MAX, lazy_first = UINT64_MAX, lazy_one = UINT64_MAX, lazy_all = UINT64_MAX;
+  std::size_t statements = 0, nodes = 0;
+  for (int i = 0; i < repeat; ++i) {
+    {
+      letter::ElapsedTimer<std::chrono::microseconds> t("eager", false);
+      statements = eager.parseAst(program)->body.size;
+      eager_first = std::min<uint64_t>(eager_first, t.elapsed());
+    }
+    {
+      letter::ElapsedTimer<std::chrono::microseconds> t("lazy", false);
+      auto* ast = lazy.parseAst(program);
+      lazy_first = std::min<uint64_t>(lazy_first, t.elapsed());
+
+      // then one block is read
+      letter::ast::cast<letter::ast::BlockStatement>(ast->body[1])->statements();
+      lazy_one = std::min<uint64_t>(lazy_one, t.elapsed());
+
+      // then all of them, nested ones included
+      lazy.validate(*ast);
+      lazy_all = std::min<uint64_t>(lazy_all, t.elapsed());
+      nodes = letter::ast::countNodes(*ast);
+    }
+  }
+
+  std::cout << "top-level statements: " << statements << ", nodes: " << nodes << std::endl;
+  std::cout << "time to first result, eager: " << eager_first << "(microseconds)" << std::endl;
+  std::cout << "time to first result, lazy: " << lazy_first << "(microseconds), "
+    << static_cast<double>(eager_first) / lazy_first << "x faster" << std::endl;
+  std::cout << "lazy, first block read: " << lazy_one << "(microseconds)" << std::endl;
+  std::cout << "lazy, every block read: " << lazy_all << "(microseconds)" << std::endl;
+
+  auto* lazy_ast = lazy.parseAst(program);
+  lazy.validate(*lazy_ast);
+  bool identical = letter::ast::toJson(*lazy_ast, lazy.symbols()) == 
+    letter::ast::toJson(*eager.parseAst(program), eager.symbols());
+  std::cout << "identical to an eager parse: " << (identical ? "yes" : "no") << std::endl;
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,72 @@
+#include "ElapsedTimer.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+#include "SourceLocation.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+int main(int argc, char** argv) {
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100 * 1024 * 1024;
+  int repeat = argc > 2 ? std::atoi(argv[2]) : 3;
+
+  auto&& program = letter::generate_program(size);
+  std::cout << "input size: " << program.size() << "(bytes)" << std::endl;
+
+  letter::Parser parser;
+  uint64_t plain = UINT64_MAX, located = UINT64_MAX;
+  for (int i = 0; i < repeat; ++i) {
+    parser.setLocations(false);
+    {
+      letter::ElapsedTimer<std::chrono::microseconds> t("no locations", false);
+      parser.parseAst(program);
+      plain = std::min<uint64_t>(plain, t.elapsed());
+    }
+    parser.setLocations(true);
+    {
+      letter::ElapsedTimer<std::chrono::microseconds> t("locations", false);
+      parser.parseAst(program);
+      located = std::min<uint64_t>(located, t.elapsed());
+    }
+  }
+  std::cout << "parse, no locations: " << plain << "(microseconds), "
+    << program.size() / 1024.0 / 1024.0 / (plain / 1e6) << " MB/s" << std::endl;
+  std::cout << "parse, locations: " << located << "(microseconds), "
+    << program.size() / 1024.0 / 1024.0 / (located / 1e6) << " MB/s, overhead "
+    << (static_cast<double>(located) / plain - 1) * 100 << "%" << std::endl;
+
+  for (auto isa : {letter::ScanIsa::Scalar, letter::ScanIsa::SSE2, letter::ScanIsa::AVX2}) {
+    if (!letter::scanIsaSupported(isa)) {
+      continue;
+    }
+    letter::LineIndex lines;
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < repeat; ++i) {
+      letter::ElapsedTimer<std::chrono::microseconds> t("line index", false);
+      lines.build(program, letter::scanKernels(isa));
+      best = std::min<uint64_t>(best, t.elapsed());
+    }
+    std::cout << "line index (" << letter::scanIsaName(isa) << "): " << best << "(microseconds), "
+      << lines.lines() << " lines" << std::endl;
+  }
+
+  // lookups, as an editor or a lint reports them
+  constexpr int kLookups = 1000000;
+  std::mt19937 rng(20231017);
+  auto&& lines = parser.lineIndex();
+  uint64_t checksum = 0;
+  {
+    letter::ElapsedTimer<std::chrono::nanoseconds> t("lookups", false);
+    for (int i = 0; i < kLookups; ++i) {
+      auto&& position = lines.position(static_cast<uint32_t>(rng() % program.size()));
+      checksum += position.line + position.column;
+    }
+    std::cout << "position lookup: " << static_cast<double>(t.elapsed()) / kLookups
+      << "(nanoseconds) each, checksum " << checksum << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,89 @@
+#include "ElapsedTimer.h"
+#include "Number.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+#include "Tokenizer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 32 * 1024 * 1024;
+  int repeat = argc > 2 ? std::atoi(argv[2]) : 3;
+
+  auto&& program = letter::generate_number_program(size);
+  std::cout << "input size: " << program.size() << "(bytes)" << std::endl;
+
+  // the texts of the numbers, as the tokenizer sees them
+  std::vector<std::string_view> texts;
+  {
+    letter::Tokenizer tokenizer;
+    tokenizer.initView(program);
+    for (auto token = tokenizer.getNextToken(); !token.empty(); token = tokenizer.getNextToken()) {
+      if (token.kind == letter::TokenKind::Number) {
+        texts.push_back(token.value);
+      }
+    }
+  }
+  std::cout << "numbers: " << texts.size() << std::endl;
+
+  // conversion alone: a string copy then std::stod, as a std::stoi based parser would need
+  // for such values, against `parseNumber` in place
+  uint64_t copied = UINT64_MAX, in_place = UINT64_MAX;
+  double checksum_copied = 0, checksum_in_place = 0;
+  for (int i = 0; i < repeat; ++i) {
+    {
+      letter::ElapsedTimer<std::chrono::microseconds> t("stod", false);
+      double sum = 0;
+      for (auto text : texts) {
+        std::string copy(text);
+        sum += copy.size() > 2 && (copy[1] == 'x' || copy[1] == 'X') ? 
+          static_cast<double>(std::stoull(copy, nullptr, 16)) : std::stod(copy);
+      }
+      copied = std::min<uint64_t>(copied, t.elapsed());
+      checksum_copied = sum;
+    }
+    {
+      letter::ElapsedTimer<std::chrono::microseconds> t("parseNumber", false);
+      double sum = 0;
+      for (auto text : texts) {
+        sum += letter::parseNumber(text).toDouble();
+      }
+      in_place = std::min<uint64_t>(in_place, t.elapsed());
+      checksum_in_place = sum;
+    }
+  }
+  std::cout << "convert, copy + stod: " << copied << "(microseconds), "
+    << texts.size() / (copied / 1e6) / 1e6 << " M numbers/s" << std::endl;
+  std::cout << "convert, parseNumber: " << in_place << "(microseconds), "
+    << texts.size() / (in_place / 1e6) / 1e6 << " M numbers/s, " 
+    << static_cast<double>(copied) / in_place << "x faster" << std::endl;
+  std::cout << "checksums: " << checksum_copied << " " << checksum_in_place << std::endl;
+
+  letter::Parser parser;
+  uint64_t tokenize = UINT64_MAX, parse = UINT64_MAX;
+  for (int i = 0; i < repeat; ++i) {
+    {
+      letter::ElapsedTimer<std::chrono::microseconds> t("tokenize", false);
+      letter::Tokenizer tokenizer;
+      tokenizer.initView(program);
+      while (!tokenizer.getNextToken().empty()) {
+      }
+      tokenize = std::min<uint64_t>(tokenize, t.elapsed());
+    }
+    {
+      letter::ElapsedTimer<std::chrono::microseconds> t("parse", false);
+      parser.parseAst(program);
+      parse = std::min<uint64_t>(parse, t.elapsed());
+    }
+  }
+  std::cout << "tokenize: " << tokenize << "(microseconds), "
+    << program.size() / 1024.0 / 1024.0 / (tokenize / 1e6) << " MB/s" << std::endl;
+  std::cout << "parse: " << parse << "(microseconds), "
+    << program.size() / 1024.0 / 1024.0 / (parse / 1e6) << " MB/s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,121 @@
+#include "ElapsedTimer.h"
+#include "Parallel.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+#include "Tokenizer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace letter;
+
+/**
+ * @brief: whether two trees are the same, atoms included
+ */
+static bool same_tree(const ast::Node* a, const ast::Node* b) {
+  if (a->type != b->type) {
+    return false;
+  }
+  auto&& same_list = [](const ast::NodeList<ast::Statement>& x, const ast::NodeList<ast::Statement>& y) {
+    if (x.size != y.size) {
+      return false;
+    }
+    for (uint32_t i = 0; i < x.size; ++i) {
+      if (!same_tree(x[i], y[i])) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  switch (a->type) {
+  case ast::NodeType::Program:
+    return same_list(static_cast<const ast::Program*>(a)->body, static_cast<const ast::Program*>(b)->body);
+  case ast::NodeType::BlockStatement:
+    return same_list(static_cast<const ast::BlockStatement*>(a)->body, static_cast<const ast::BlockStatement*>(b)->body);
+  case ast::NodeType::ExpressionStatement:
+    return same_tree(static_cast<const ast::ExpressionStatement*>(a)->expression,
+                     static_cast<const ast::ExpressionStatement*>(b)->expression);
+  case ast::NodeType::AssignmentExpression: {
+    auto* x = static_cast<const ast::AssignmentExpression*>(a);
+    auto* y = static_cast<const ast::AssignmentExpression*>(b);
+    return x->op == y->op && same_tree(x->left, y->left) && same_tree(x->right, y->right);
+  }
+  case ast::NodeType::BinaryExpression: {
+    auto* x = static_cast<const ast::BinaryExpression*>(a);
+    auto* y = static_cast<const ast::BinaryExpression*>(b);
+    return x->op == y->op && same_tree(x->left, y->left) && same_tree(x->right, y->right);
+  }
+  case ast::NodeType::Identifier:
+    return static_cast<const ast::Identifier*>(a)->name == static_cast<const ast::Identifier*>(b)->name;
+  case ast::NodeType::NumericLiteral: {
+    auto&& x = static_cast<const ast::NumericLiteral*>(a)->value;
+    auto&& y = static_cast<const ast::NumericLiteral*>(b)->value;
+    return x.kind == y.kind && (x.isReal() ? x.real == y.real : x.integer == y.integer);
+  }
+  case ast::NodeType::StringLiteral:
+    return static_cast<const ast::StringLiteral*>(a)->value == static_cast<const ast::StringLiteral*>(b)->value;
+  default:
+    return true;
+  }
+}
+
+/**
+ * @brief: parse one large source serially, then with 2, 4... up to `max_threads` workers,
+ * print the throughput and check every tree against the serial one
+ */
+int main(int argc, char** argv) {
+  std::size_t mb = 100;
+  unsigned max_threads = hardwareThreads();
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (std::string(argv[i]) == "-t") {
+      max_threads = static_cast<unsigned>(std::atoi(argv[i + 1]));
+    } else if (std::string(argv[i]) == "-m") {
+      mb = static_cast<std::size_t>(std::atoi(argv[i + 1]));
+    }
+  }
+  max_threads = std::max(max_threads, 2u);
+
+  auto&& program = generate_names_program(mb * 1024 * 1024, 5000);
+  const double megabytes = program.size() / 1024.0 / 1024.0;
+  std::cout << "hardware threads: " << hardwareThreads() << ", source: " << program.size() << "(bytes)" << std::endl;
+
+  {
+    ElapsedTimer<std::chrono::microseconds> t("splitTopLevel", false);
+    auto&& cuts = splitTopLevel(program, program.size() / (max_threads * 4));
+    auto us = t.elapsed();
+    std::cout << "pre-scan: " << us << "(microseconds), " << megabytes / (us / 1e6) << " MB/s, "
+      << cuts.size() + 1 << " parts" << std::endl;
+  }
+
+  Parser serial;
+  ast::Program* expected = nullptr;
+  double base = 0;
+  {
+    ElapsedTimer<std::chrono::microseconds> t("serial", false);
+    expected = serial.parseAst(program);
+    auto us = t.elapsed();
+    base = megabytes / (us / 1e6);
+    std::cout << "serial: " << us << "(microseconds), " << base << " MB/s" << std::endl;
+  }
+
+  for (unsigned threads = 2; ; threads = std::min(threads * 2, max_threads)) {
+    Parser parser;
+    parser.setThreads(threads);
+
+    ElapsedTimer<std::chrono::microseconds> t("parallel", false);
+    auto* actual = parser.parseAst(program);
+    auto us = t.elapsed();
+
+    double mb_per_s = megabytes / (us / 1e6);
+    std::cout << threads << " threads: " << us << "(microseconds), " << mb_per_s << " MB/s, x"
+      << mb_per_s / base << ", " << (same_tree(expected, actual) ? "same tree" : "DIFFERENT TREE") << std::endl;
+
+    if (threads == max_threads) {
+      break;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+#include "ElapsedTimer.h"
+#include "Instrument.h"
+#include "ParseContext.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief: parse every snippet once to warm up, then once more timing each parse;
+ * print mean, p50 and p99 latencies, the throughput and, when instrumented, the allocations per parse
+ */
+static uint64_t measure(const std::string& name, const std::vector<std::string>& snippets, std::size_t bytes,
+    const std::function<uint64_t(const std::string&)>& parse) {
+  uint64_t checksum = 0;
+  for (auto&& snippet : snippets) {
+    checksum += parse(snippet);
+  }
+
+  std::vector<uint64_t> latencies;
+  latencies.reserve(snippets.size());
+  letter::instrument::reset();
+  for (auto&& snippet : snippets) {
+    letter::ElapsedTimer<std::chrono::nanoseconds> t(name, false);
+    checksum += parse(snippet);
+    latencies.push_back(t.elapsed());
+  }
+  auto&& stats = letter::instrument::snapshot();
+
+  std::sort(latencies.begin(), latencies.end());
+  uint64_t total = 0;
+  for (auto ns : latencies) {
+    total += ns;
+  }
+  const std::size_t n = latencies.size();
+
+  std::cout << name << ": mean " << total / static_cast<double>(n) / 1000.0
+    << "(microseconds), p50 " << latencies[n / 2] / 1000.0
+    << ", p99 " << latencies[n * 99 / 100] / 1000.0
+    << ", " << n / (total / 1e9) / 1e6 << " M parses/s, "
+    << bytes / 1024.0 / 1024.0 / (total / 1e9) << " MB/s" << std::endl;
+  if (letter::instrument::kEnabled) {
+    uint64_t allocations = 0;
+    for (auto&& phase : stats.phases) {
+      allocations += phase.count;
+    }
+    std::cout << "  allocations per parse: " << static_cast<double>(allocations) / n << std::endl;
+  }
+  return checksum;
+}
+
+int main(int argc, char** argv) {
+  std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+  std::size_t min_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10;
+  std::size_t max_size = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 100;
+
+  auto&& snippets = letter::generate_snippets(count, min_size, max_size);
+  std::size_t bytes = 0;
+  for (auto&& snippet : snippets) {
+    bytes += snippet.size();
+  }
+  std::cout << "snippets: " << snippets.size() << ", " << min_size << " to " << max_size
+    << "(bytes), mean " << bytes / static_cast<double>(snippets.size()) << "(bytes)" << std::endl;
+
+  uint64_t checksum = measure("fresh parser", snippets, bytes, [](const std::string& snippet) {
+    letter::Parser parser;
+    return static_cast<uint64_t>(parser.parseAst(snippet)->body.size);
+  });
+
+  letter::Parser parser;
+  checksum += measure("reused parser", snippets, bytes, [&](const std::string& snippet) {
+    return static_cast<uint64_t>(parser.parseAst(snippet)->body.size);
+  });
+
+  letter::ParseContext context;
+  checksum += measure("parse context", snippets, bytes, [&](const std::string& snippet) {
+    return static_cast<uint64_t>(context.parse(snippet)->body.size);
+  });
+  std::cout << "arena reserved by the context: " << context.bytesReserved() << "(bytes), checksum "
+    << checksum << std::endl;
+  return 0;
+}
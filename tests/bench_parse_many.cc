@@ -0,0 +1,77 @@
+#include "ElapsedTimer.h"
+#include "Parallel.h"
+#include "ParseMany.h"
+#include "ProgramGenerator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief: parse all the inputs with 1, 2, 4... up to `max_threads` workers, print the throughput
+ */
+template <typename Inputs>
+static void bench(const Inputs& inputs, std::size_t bytes, unsigned max_threads) {
+  double base = 0;
+  for (unsigned threads = 1; ; threads = std::min(threads * 2, max_threads)) {
+    letter::ElapsedTimer<std::chrono::microseconds> t("parseMany", false);
+    auto&& results = letter::parseMany(inputs, threads);
+    auto us = t.elapsed();
+
+    std::size_t failed = 0;
+    for (auto&& result : results) {
+      failed += !result.ok();
+    }
+
+    double mb_per_s = bytes / 1024.0 / 1024.0 / (us / 1e6);
+    if (threads == 1) {
+      base = mb_per_s;
+    }
+    std::cout << threads << " threads: " << us << "(microseconds), " << mb_per_s << " MB/s, x"
+      << mb_per_s / base << ", " << results.size() - failed << " parsed, " << failed << " failed" << std::endl;
+
+    if (threads == max_threads) {
+      break;
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  unsigned max_threads = letter::hardwareThreads();
+  if (argc > 1 && std::string(argv[1]) == "-t") {
+    max_threads = static_cast<unsigned>(std::atoi(argv[2]));
+    argc -= 2;
+    argv += 2;
+  }
+  std::cout << "hardware threads: " << letter::hardwareThreads() << std::endl;
+
+  // files given on the command line, or generated sources of uneven sizes
+  if (argc > 1) {
+    std::vector<std::string> paths(argv + 1, argv + argc);
+    std::size_t bytes = 0;
+    for (auto&& path : paths) {
+      std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+      bytes += static_cast<std::size_t>(std::max<std::streamoff>(0, ifs.tellg()));
+    }
+    std::cout << "files: " << paths.size() << ", " << bytes << "(bytes)" << std::endl;
+    bench(paths, bytes, max_threads);
+    return 0;
+  }
+
+  std::mt19937 rng(20231017);
+  std::vector<std::string> programs(10000);
+  std::size_t bytes = 0;
+  for (std::size_t i = 0; i < programs.size(); ++i) {
+    programs[i] = letter::generate_program(512 + rng() % (16 * 1024), static_cast<uint32_t>(i));
+    bytes += programs[i].size();
+  }
+  std::vector<std::string_view> sources(programs.begin(), programs.end());
+
+  std::cout << "sources: " << sources.size() << ", " << bytes << "(bytes)" << std::endl;
+  bench(sources, bytes, max_threads);
+  return 0;
+}
@@ -0,0 +1,65 @@
+#include "ElapsedTimer.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+/**
+ * count every heap allocation of the process, the letter library included
+ */
+static std::size_t s_alloc_count = 0;
+static std::size_t s_alloc_bytes = 0;
+
+void* operator new(std::size_t size) {
+  ++s_alloc_count;
+  s_alloc_bytes += size;
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static void report(const char* name, std::size_t nodes, uint64_t us, std::size_t bytes) {
+  double seconds = us / 1e6;
+  if (seconds <= 0) {
+    seconds = 1e-6;
+  }
+
+  std::cout << name << ": " << us << "(microseconds), "
+    << static_cast<uint64_t>(nodes / seconds) << " nodes/s, "
+    << static_cast<double>(bytes) / nodes << " bytes/node" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4 * 1024 * 1024;
+  auto&& program = letter::generate_program(size);
+
+  std::cout << "input size: " << program.size() << "(bytes)" << std::endl;
+
+  letter::Parser parser;
+
+  // warm up, so the arena blocks are already there
+  parser.parseAst(program);
+
+  letter::ElapsedTimer t("typed", false);
+  auto* ast = parser.parseAst(program);
+  auto us = t.elapsed();
+
+  std::size_t nodes = letter::ast::countNodes(*ast);
+  std::cout << "nodes: " << nodes << std::endl;
+  report("typed ast (arena)", nodes, us, parser.arena().bytesUsed());
+
+  // the json tree, as the parser used to build it for every grammar rule
+  std::size_t alloc_bytes = s_alloc_bytes;
+  t.reset();
+  auto&& json = letter::ast::toJson(*ast, parser.symbols());
+  report("json tree (export)", nodes, us + t.elapsed(), s_alloc_bytes - alloc_bytes);
+
+  return json.is_object() ? 0 : 1;
+}
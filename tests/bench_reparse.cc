@@ -0,0 +1,81 @@
+#include "ElapsedTimer.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static bool is_word_char(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+int main(int argc, char** argv) {
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1024 * 1024;
+  int edits = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+  auto&& program = letter::generate_program(size);
+  std::cout << "input size: " << program.size() << "(bytes)" << std::endl;
+
+  // typing after a word char keeps the program valid: a longer name, number, comment or string
+  std::vector<std::size_t> positions;
+  for (std::size_t i = 0; i < program.size(); ++i) {
+    if (is_word_char(program[i])) {
+      positions.push_back(i + 1);
+    }
+  }
+
+  letter::Parser parser;
+  parser.setIncremental(true);
+  {
+    letter::ElapsedTimer t("full parse");
+    parser.parseAst(program);
+  }
+  std::cout << "nodes: " << parser.reparseStats().nodes << std::endl;
+
+  std::mt19937 rng(20231017);
+  std::vector<uint64_t> latencies;
+  latencies.reserve(edits * 2);
+  double reused = 0;
+  int full_parses = 0;
+  letter::ast::Program* ast = nullptr;
+
+  for (int i = 0; i < edits; ++i) {
+    auto offset = positions[rng() % positions.size()];
+    auto inserted = (program[offset - 1] >= '0' && program[offset - 1] <= '9') ? "7" : "z";
+
+    // type a char, then delete it
+    for (auto&& edit : {letter::TextEdit{offset, 0, inserted}, letter::TextEdit{offset, 1, ""}}) {
+      letter::ElapsedTimer<std::chrono::nanoseconds> t("reparse", false);
+      ast = parser.reparseAst(edit);
+      latencies.push_back(t.elapsed());
+
+      reused += parser.reparseStats().reusedFraction();
+      full_parses += parser.reparseStats().full;
+    }
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  uint64_t total = 0;
+  for (auto ns : latencies) {
+    total += ns;
+  }
+  const std::size_t n = latencies.size();
+
+  std::cout << "single char edits: " << n << ", mean " << total / n / 1000.0
+    << "(microseconds), p50 " << latencies[n / 2] / 1000.0
+    << ", p99 " << latencies[n * 99 / 100] / 1000.0 << std::endl;
+  std::cout << "reused nodes: " << reused / n * 100 << "%, full parses (arena compaction): " 
+    << full_parses << std::endl;
+
+  // every edit was undone, the last tree must be the one of a full parse
+  letter::Parser reference;
+  bool identical = parser.source() == program &&
+    letter::ast::toJson(*ast, parser.symbols()) == reference.parse(program);
+  std::cout << "identical to a full parse: " << (identical ? "yes" : "no") << std::endl;
+
+  return identical ? 0 : 1;
+}
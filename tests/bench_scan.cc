@@ -0,0 +1,146 @@
+#include "ElapsedTimer.h"
+#include "ProgramGenerator.h"
+#include "Scan.h"
+#include "Tokenizer.h"
+
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace letter;
+
+static const ScanIsa s_isas[] = {ScanIsa::Scalar, ScanIsa::SSE2, ScanIsa::AVX2};
+
+/**
+ * @brief: every kernel of every supported isa must give the offsets of the scalar one,
+ * on short random inputs from every start, so each tail and vector boundary is crossed
+ */
+static bool check_kernels() {
+  static const char s_alphabet[] = {' ', '\t', '\n', '\r', '\v', '*', '/', '"', '\'', 'a', '\x80', '\xff'};
+  std::mt19937 rng(20231017);
+  const ScanKernels& scalar = scanKernels(ScanIsa::Scalar);
+  std::size_t mismatches = 0;
+
+  for (int round = 0; round < 2000; ++round) {
+    std::string input(rng() % 100, ' ');
+    for (auto& c : input) {
+      // mostly white space, so runs are long enough for the vectors
+      c = rng() % 4 ? ' ' : s_alphabet[rng() % sizeof(s_alphabet)];
+    }
+    const char* s = input.data();
+    const std::size_t size = input.size();
+
+    for (auto isa : s_isas) {
+      if (!scanIsaSupported(isa)) {
+        continue;
+      }
+      const ScanKernels& k = scanKernels(isa);
+      for (std::size_t i = 0; i <= size; ++i) {
+        mismatches += k.skipWhitespace(s, i, size) != scalar.skipWhitespace(s, i, size);
+        mismatches += k.findCommentClose(s, i, size) != scalar.findCommentClose(s, i, size);
+        mismatches += k.findQuote(s, i, size, '"') != scalar.findQuote(s, i, size, '"');
+        mismatches += k.findLineEnd(s, i, size) != scalar.findLineEnd(s, i, size);
+      }
+    }
+  }
+
+  std::cout << "kernels check: " << mismatches << " mismatches" << std::endl;
+  return mismatches == 0;
+}
+
+/**
+ * @brief: scan `input` from the start `repeat` times, print the throughput
+ */
+static void bench_kernel(const char* name, const std::string& input, int repeat,
+    const std::function<std::size_t(const ScanKernels&, const char*, std::size_t)>& kernel) {
+  for (auto isa : s_isas) {
+    if (!scanIsaSupported(isa)) {
+      std::cout << name << " " << scanIsaName(isa) << ": not supported" << std::endl;
+      continue;
+    }
+    const ScanKernels& k = scanKernels(isa);
+    std::size_t found = 0;
+
+    ElapsedTimer<std::chrono::microseconds> t(name, false);
+    for (int r = 0; r < repeat; ++r) {
+      found += kernel(k, input.data(), input.size());
+    }
+    auto us = std::max<uint64_t>(t.elapsed(), 1);
+
+    std::cout << name << " " << scanIsaName(isa) << ": " 
+      << input.size() * repeat / 1024.0 / 1024.0 / (us / 1e6) << " MB/s"
+      << (found == input.size() * repeat - repeat ? "" : " (wrong offset)") << std::endl;
+  }
+}
+
+/**
+ * @brief: tokenize a trivia heavy program with the kernels of every isa
+ */
+static void bench_tokenizer(const std::string& program) {
+  for (auto isa : s_isas) {
+    if (!scanIsaSupported(isa)) {
+      continue;
+    }
+    Tokenizer tokenizer;
+    tokenizer.initView(program);
+    tokenizer.setScanIsa(isa);
+
+    std::size_t tokens = 0;
+    ElapsedTimer<std::chrono::microseconds> t("tokenizer", false);
+    while (!tokenizer.getNextToken().empty()) {
+      ++tokens;
+    }
+    auto us = std::max<uint64_t>(t.elapsed(), 1);
+
+    std::cout << "tokenizer " << scanIsaName(isa) << ": " << tokens << " tokens, "
+      << program.size() / 1024.0 / 1024.0 / (us / 1e6) << " MB/s" << std::endl;
+  }
+}
+
+int main(int argc, char** argv) {
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16 * 1024 * 1024;
+  const int repeat = 8;
+  std::cout << "best isa: " << scanIsaName(scanKernels().isa) << ", input size: " << size << "(bytes)" << std::endl;
+
+  if (!check_kernels()) {
+    return 1;
+  }
+
+  // every input ends with what the kernel looks for, so it runs over all of the bytes
+  std::string spaces(size, ' ');
+  for (std::size_t i = 0; i < size; i += 7) {
+    spaces[i] = "\t\n\r"[i % 3];
+  }
+  spaces.back() = 'x';
+  bench_kernel("whitespace", spaces, repeat, [](const ScanKernels& k, const char* s, std::size_t n) {
+    return k.skipWhitespace(s, 0, n);
+  });
+
+  std::string comment(size, 'c');
+  for (std::size_t i = 0; i < size; i += 5) {
+    comment[i] = i % 2 ? '*' : '/';  // lone "*" and "/" but no "*/" before the end
+  }
+  comment[size - 2] = '*';
+  comment[size - 1] = '/';
+  bench_kernel("comment close", comment, repeat, [](const ScanKernels& k, const char* s, std::size_t n) {
+    return k.findCommentClose(s, 0, n) + 1;
+  });
+
+  std::string text(size, 's');
+  text.back() = '"';
+  bench_kernel("quote", text, repeat, [](const ScanKernels& k, const char* s, std::size_t n) {
+    return k.findQuote(s, 0, n, '"');
+  });
+
+  std::string line(size, 'l');
+  line.back() = '\n';
+  bench_kernel("line end", line, repeat, [](const ScanKernels& k, const char* s, std::size_t n) {
+    return k.findLineEnd(s, 0, n);
+  });
+
+  bench_tokenizer(generate_program(size));
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include "BinaryAst.h"
+#include "ElapsedTimer.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+/**
+ * @brief: the start of a service on an unchanged script bundle:
+ * a cold parse, the same parse storing its tree, a warm load from the cache,
+ * and the json form of the loaded tree
+ */
+int main(int argc, char** argv) {
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16 * 1024 * 1024;
+
+  auto&& directory = std::filesystem::temp_directory_path() / "letter_bench_startup";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  const std::string bundle = (directory / "bundle.lt").string();
+  const std::string cache = (directory / "cache").string();
+  {
+    std::ofstream ofs(bundle, std::ios::binary);
+    ofs << letter::generate_names_program(size, 2000);
+  }
+  std::cout << "bundle: " << std::filesystem::file_size(bundle) << "(bytes)" << std::endl;
+
+  auto&& measure = [&](const char* name, letter::Parser& parser) {
+    letter::ElapsedTimer<std::chrono::microseconds> t(name, false);
+    auto* program = parser.parseFileAst(bundle);
+    auto us = t.elapsed();
+    std::cout << name << ": " << us << "(microseconds)" << (parser.cacheHit() ? ", from the cache" : "") << std::endl;
+    return program;
+  };
+
+  json::value cold_json;
+  {
+    letter::Parser parser;
+    auto* program = measure("cold parse         ", parser);
+    cold_json = letter::ast::toJson(*program, parser.symbols());
+  }
+  {
+    letter::Parser parser;
+    parser.setCacheDirectory(cache);
+    measure("cold parse + store ", parser);
+  }
+  for (auto&& entry : std::filesystem::directory_iterator(cache)) {
+    std::cout << "cache entry: " << entry.path().filename().string() << ", " << entry.file_size() << "(bytes)" << std::endl;
+  }
+
+  letter::Parser parser;
+  parser.setCacheDirectory(cache);
+  auto* program = measure("warm load          ", parser);
+  {
+    letter::ElapsedTimer<std::chrono::microseconds> t("json", false);
+    auto&& exported = letter::ast::toJson(*program, parser.symbols());
+    auto us = t.elapsed();
+    std::cout << "json re-export     : " << us << "(microseconds), " 
+      << (exported == cold_json ? "same as the cold parse" : "DIFFERENT from the cold parse") << std::endl;
+  }
+
+  std::filesystem::remove_all(directory);
+  return 0;
+}
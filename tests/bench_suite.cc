@@ -0,0 +1,369 @@
+#include "json.hpp"
+
+#include "Ast.h"
+#include "ElapsedTimer.h"
+#include "Instrument.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+#include "Tokenizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if LETTER_INSTRUMENT
+
+// the library replaces operator new already, and counts every allocation
+static uint64_t allocations() {
+  uint64_t count = 0;
+  for (auto&& phase : letter::instrument::snapshot().phases) {
+    count += phase.count;
+  }
+  return count;
+}
+
+#else
+
+/**
+ * Counting allocator: every `operator new` of the process, the library's included,
+ * so a benchmark can tell how many heap allocations it made.
+ */
+static std::atomic<uint64_t> s_allocations{0};
+
+void* operator new(std::size_t size) {
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static uint64_t allocations() { return s_allocations.load(); }
+
+#endif
+
+namespace {
+
+constexpr int kFormatVersion = 1; // of the result file
+
+struct Options {
+  double scale = 1;           // multiplies every input size
+  int repeat = 3;             // runs of each benchmark, the fastest one counts
+  uint32_t seed = 20231017;
+  std::string filter;         // only the benchmarks whose name contains it
+  std::string out = "bench.json";
+};
+
+/**
+ * @brief: a deterministic input, named after its shape and size
+ */
+struct Workload {
+  std::string name;
+  std::string program;
+};
+
+struct Result {
+  std::string name;
+  std::size_t bytes = 0;
+  std::size_t tokens = 0;
+  std::size_t nodes = 0;                 // 0 for the tokenizer
+  double seconds = 0;                    // the fastest run
+  double allocs_per_node = 0;            // first parse, with a new parser
+  double steady_allocs_per_node = 0;     // next parses, with the same parser
+
+  json::value toJson() const {
+    return json::object{
+      {"name", this->name},
+      {"bytes", static_cast<unsigned long long>(this->bytes)},
+      {"tokens", static_cast<unsigned long long>(this->tokens)},
+      {"nodes", static_cast<unsigned long long>(this->nodes)},
+      {"seconds", this->seconds},
+      {"tokens_per_s", this->tokens / this->seconds},
+      {"mb_per_s", this->bytes / 1024.0 / 1024.0 / this->seconds},
+      {"ns_per_node", this->nodes ? this->seconds * 1e9 / this->nodes : 0.0},
+      {"allocs_per_node", this->allocs_per_node},
+      {"steady_allocs_per_node", this->steady_allocs_per_node},
+    };
+  }
+};
+
+std::string size_name(std::size_t size) {
+  return size >= 1024 * 1024 ? std::to_string(size / (1024 * 1024)) + "MB" : std::to_string(size / 1024) + "KB";
+}
+
+/**
+ * @brief: a program of about `size` bytes repeating one grammar construct
+ */
+std::string construct_program(const std::string& construct, std::size_t size, uint32_t seed) {
+  std::mt19937 rng(seed);
+  auto&& name = [&]() { return "v" + std::to_string(rng() % 256); };
+  auto&& number = [&]() { return std::to_string(rng() % 100000); };
+
+  std::string program;
+  program.reserve(size + 64);
+  while (program.size() < size) {
+    if (construct == "assignment") {
+      program += name() + " = " + name() + ";\n";
+    } else if (construct == "compound_assignment") {
+      program += name() + " += " + number() + ";\n";
+    } else if (construct == "binary") {
+      program += name() + " + " + name() + " * " + number() + ";\n";
+    } else if (construct == "parenthesized") {
+      program += "((" + name() + " - " + number() + "));\n";
+    } else if (construct == "block") {
+      program += "{ " + name() + "; }\n";
+    } else if (construct == "empty") {
+      program += ";\n";
+    } else if (construct == "number") {
+      program += number() + ";\n";
+    } else {
+      program += "'" + name() + " text';\n";
+    }
+  }
+  return program;
+}
+
+std::vector<Workload> make_workloads(const Options& options) {
+  std::vector<Workload> workloads;
+  auto&& scaled = [&](std::size_t size) {
+    return std::max<std::size_t>(1024, static_cast<std::size_t>(size * options.scale));
+  };
+
+  using Generator = std::function<std::string(std::size_t)>;
+  const std::vector<std::pair<const char*, Generator>> shapes = {
+    {"mixed", [&](std::size_t n) { return letter::generate_program(n, options.seed); }},
+    {"names", [&](std::size_t n) { return letter::generate_names_program(n, 300, options.seed); }},
+    {"nested", [&](std::size_t n) { return letter::generate_nested_program(n, 64, options.seed); }},
+    {"chain", [&](std::size_t n) { return letter::generate_chain_program(n, 256, options.seed); }},
+    {"comments", [&](std::size_t n) { return letter::generate_comment_program(n, 2048, options.seed); }},
+    {"strings", [&](std::size_t n) { return letter::generate_string_program(n, 1024, options.seed); }},
+    {"numbers", [&](std::size_t n) { return letter::generate_number_program(n, options.seed); }},
+  };
+  for (auto&& [shape, generate] : shapes) {
+    for (std::size_t size : {64 * 1024, 1024 * 1024, 8 * 1024 * 1024}) {
+      workloads.push_back({std::string(shape) + "/" + size_name(scaled(size)), generate(scaled(size))});
+    }
+  }
+
+  for (auto* construct : {"assignment", "compound_assignment", "binary", "parenthesized", 
+      "block", "empty", "number", "string"}) {
+    const std::size_t size = scaled(1024 * 1024);
+    workloads.push_back({std::string("construct/") + construct + "/" + size_name(size),
+        construct_program(construct, size, options.seed)});
+  }
+  return workloads;
+}
+
+/**
+ * @brief: the fastest of `repeat` runs of `run`, in seconds
+ */
+double fastest(int repeat, const std::function<void()>& run) {
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < repeat; ++i) {
+    letter::ElapsedTimer<std::chrono::nanoseconds> t("run", false);
+    run();
+    best = std::min(best, std::max<uint64_t>(t.elapsed(), 1) / 1e9);
+  }
+  return best;
+}
+
+Result bench_tokenizer(const Workload& workload, const Options& options) {
+  Result result;
+  result.name = "tokenizer/" + workload.name;
+  result.bytes = workload.program.size();
+
+  letter::Tokenizer tokenizer;
+  result.seconds = fastest(options.repeat, [&]() {
+    tokenizer.initView(workload.program);
+    result.tokens = 0;
+    while (!tokenizer.getNextToken().empty()) {
+      ++result.tokens;
+    }
+  });
+  return result;
+}
+
+Result bench_parser(const Workload& workload, std::size_t tokens, const Options& options) {
+  Result result;
+  result.name = "parser/" + workload.name;
+  result.bytes = workload.program.size();
+  result.tokens = tokens;
+
+  letter::Parser parser;
+  uint64_t before = allocations();
+  auto* program = parser.parseAst(workload.program);
+  result.nodes = letter::ast::countNodes(*program);
+  result.allocs_per_node = double(allocations() - before) / result.nodes;
+
+  before = allocations();
+  result.seconds = fastest(options.repeat, [&]() { parser.parseAst(workload.program); });
+  result.steady_allocs_per_node = double(allocations() - before) / options.repeat / result.nodes;
+  return result;
+}
+
+int run(const Options& options) {
+  json::array results;
+  std::cout << std::left << std::setw(44) << "benchmark" << std::right << std::setw(12) << "MB/s" 
+    << std::setw(14) << "Mtokens/s" << std::setw(12) << "ns/node" << std::setw(14) << "allocs/node" << std::endl;
+
+  auto&& report = [&](const Result& result) {
+    auto&& value = result.toJson();
+    std::cout << std::left << std::setw(44) << result.name << std::right << std::fixed << std::setprecision(2)
+      << std::setw(12) << value.at("mb_per_s").as_double() 
+      << std::setw(14) << value.at("tokens_per_s").as_double() / 1e6
+      << std::setw(12) << value.at("ns_per_node").as_double()
+      << std::setw(14) << std::setprecision(4) << result.allocs_per_node << std::endl;
+    results.emplace_back(std::move(value));
+  };
+
+  for (auto&& workload : make_workloads(options)) {
+    if (workload.name.find(options.filter) == std::string::npos) {
+      continue;
+    }
+    auto&& tokenizer = bench_tokenizer(workload, options);
+    report(tokenizer);
+    report(bench_parser(workload, tokenizer.tokens, options));
+  }
+
+  json::value file = json::object{
+    {"format", "letter-bench"},
+    {"version", kFormatVersion},
+    {"seed", static_cast<unsigned>(options.seed)},
+    {"scale", options.scale},
+    {"repeat", options.repeat},
+    {"results", results},
+  };
+  std::ofstream ofs(options.out);
+  ofs << file.format(true) << std::endl;
+  if (!ofs) {
+    std::cerr << "cannot write " << options.out << std::endl;
+    return 2;
+  }
+  std::cout << "results written to " << options.out << std::endl;
+  return 0;
+}
+
+std::optional<json::value> load(const std::string& path) {
+  std::ifstream ifs(path);
+  if (!ifs.is_open()) {
+    std::cerr << "cannot read " << path << std::endl;
+    return std::nullopt;
+  }
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+  auto&& file = json::parse(ss.str());
+  if (!file || !file->find("version") || file->at("version").as_integer() != kFormatVersion) {
+    std::cerr << path << " is not a result file of version " << kFormatVersion << std::endl;
+    return std::nullopt;
+  }
+  return file;
+}
+
+/**
+ * @brief: compare the results of `current` against `baseline`, benchmark by benchmark
+ * A benchmark regresses if its throughput drops by more than `threshold` (0.10 is 10%),
+ * or if it allocates more per node. Returns 1 if anything regressed.
+ */
+int compare(const std::string& baseline_path, const std::string& current_path, double threshold) {
+  auto&& baseline = load(baseline_path);
+  auto&& current = load(current_path);
+  if (!baseline || !current) {
+    return 2;
+  }
+
+  std::map<std::string, json::value> base;
+  for (auto&& result : baseline->at("results").as_array()) {
+    base.emplace(result.at("name").as_string(), result);
+  }
+
+  std::size_t regressions = 0;
+  std::cout << std::left << std::setw(44) << "benchmark" << std::right << std::setw(12) << "base MB/s" 
+    << std::setw(12) << "MB/s" << std::setw(10) << "change" << std::endl;
+  for (auto&& result : current->at("results").as_array()) {
+    auto&& name = result.at("name").as_string();
+    auto it = base.find(name);
+    if (it == base.end()) {
+      std::cout << std::left << std::setw(44) << name << "  new, no baseline" << std::endl;
+      continue;
+    }
+
+    const double before = it->second.at("mb_per_s").as_double();
+    const double after = result.at("mb_per_s").as_double();
+    const double change = before > 0 ? after / before - 1 : 0;
+    const bool slower = change < -threshold;
+    const bool allocates = result.at("steady_allocs_per_node").as_double() > 
+      it->second.at("steady_allocs_per_node").as_double() * (1 + threshold) + 1e-6;
+
+    std::cout << std::left << std::setw(44) << name << std::right << std::fixed << std::setprecision(2)
+      << std::setw(12) << before << std::setw(12) << after << std::setw(9) << change * 100 << "%"
+      << (slower ? "  REGRESSION" : "") << (allocates ? "  MORE ALLOCATIONS" : "") << std::endl;
+    regressions += slower || allocates;
+    base.erase(it);
+  }
+  for (auto&& [name, result] : base) {
+    std::cout << std::left << std::setw(44) << name << "  missing from " << current_path << std::endl;
+  }
+
+  std::cout << regressions << " regression(s), threshold " << threshold * 100 << "%" << std::endl;
+  return regressions ? 1 : 0;
+}
+
+void usage() {
+  std::cout << "usage:\n"
+    << "  bench_suite [--scale S] [--repeat N] [--seed N] [--filter TEXT] [--out FILE]\n"
+    << "  bench_suite --compare BASELINE CURRENT [--threshold 0.10]" << std::endl;
+}
+
+} // namespace
+
+/**
+ * @brief: the benchmark suite, `make bench` runs it
+ * Tokenizer and parser throughput over seeded synthetic programs of every shape and size,
+ * and over one program per grammar construct. Results go to a json file, which `--compare`
+ * checks against an earlier one.
+ */
+int main(int argc, char** argv) {
+  Options options;
+  std::vector<std::string> args(argv + 1, argv + argc);
+  double threshold = 0.10;
+
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    auto&& arg = args[i];
+    const bool has_value = i + 1 < args.size();
+    if (arg == "--compare" && i + 2 < args.size()) {
+      for (std::size_t j = i + 3; j + 1 < args.size(); ++j) {
+        if (args[j] == "--threshold") {
+          threshold = std::atof(args[j + 1].c_str());
+        }
+      }
+      return compare(args[i + 1], args[i + 2], threshold);
+    } else if (arg == "--scale" && has_value) {
+      options.scale = std::atof(args[++i].c_str());
+    } else if (arg == "--repeat" && has_value) {
+      options.repeat = std::max(1, std::atoi(args[++i].c_str()));
+    } else if (arg == "--seed" && has_value) {
+      options.seed = static_cast<uint32_t>(std::strtoul(args[++i].c_str(), nullptr, 10));
+    } else if (arg == "--filter" && has_value) {
+      options.filter = args[++i];
+    } else if (arg == "--out" && has_value) {
+      options.out = args[++i];
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  return run(options);
+}
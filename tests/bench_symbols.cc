@@ -0,0 +1,34 @@
+#include "ElapsedTimer.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16 * 1024 * 1024;
+  std::size_t unique_names = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 300;
+  auto&& program = letter::generate_names_program(size, unique_names);
+
+  std::cout << "input size: " << program.size() << "(bytes), " << unique_names << " names" << std::endl;
+
+  letter::Parser parser;
+  letter::ElapsedTimer t("parse", false);
+  auto* ast = parser.parseAst(program);
+  auto us = t.elapsed();
+
+  auto&& stats = parser.symbols().stats();
+  std::cout << "parse: " << us << "(microseconds), " << letter::ast::countNodes(*ast) << " nodes\n"
+    << "unique atoms: " << stats.unique_atoms << "\n"
+    << "occurrences: " << stats.occurrences << "\n"
+    << "bytes of all occurrences: " << stats.interned_bytes << "\n"
+    << "bytes stored: " << stats.stored_bytes << "\n"
+    << "bytes saved: " << stats.interned_bytes - stats.stored_bytes << "\n"
+    // a std::string per occurrence, as the json nodes hold, costs at least its own object
+    << "std::string objects avoided: " << stats.occurrences - stats.unique_atoms 
+    << " (" << (stats.occurrences - stats.unique_atoms) * sizeof(std::string) << " bytes)\n"
+    << "table memory: " << stats.table_bytes << "(bytes)" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,66 @@
+#include "ElapsedTimer.h"
+#include "Tokenizer.h"
+#include "ProgramGenerator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief: tokenize the whole program, return all the tokens
+ * the tokens view the buffer of `tokenizer`
+ */
+static std::vector<letter::Token> tokenize(letter::Tokenizer& tokenizer) {
+  std::vector<letter::Token> tokens;
+  for (auto token = tokenizer.getNextToken(); !token.empty(); token = tokenizer.getNextToken()) {
+    tokens.emplace_back(token);
+  }
+  return tokens;
+}
+
+static bool same_tokens(const std::vector<letter::Token>& a, const std::vector<letter::Token>& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), 
+      [](const letter::Token& l, const letter::Token& r) {
+        return l.kind == r.kind && l.value == r.value;
+      });
+}
+
+static void report(const char* name, std::size_t bytes, std::size_t tokens, uint64_t us) {
+  double seconds = us / 1e6;
+  if (seconds <= 0) {
+    seconds = 1e-6;
+  }
+
+  std::cout << name << ": " << tokens << " tokens in " << us << "(microseconds), "
+    << static_cast<uint64_t>(tokens / seconds) << " tokens/s, "
+    << (bytes / seconds / (1024 * 1024)) << " MB/s" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  // the regex engine is slow, keep the default input small
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64 * 1024;
+  auto&& program = letter::generate_program(size);
+
+  std::cout << "input size: " << program.size() << "(bytes)" << std::endl;
+
+  letter::Tokenizer scanner(program, letter::Tokenizer::Engine::Scanner);
+  letter::Tokenizer regex(program, letter::Tokenizer::Engine::Regex);
+
+  letter::ElapsedTimer t("scanner", false);
+  auto&& scanned = tokenize(scanner);
+  report("scanner", program.size(), scanned.size(), t.elapsed());
+
+  t.reset();
+  auto&& matched = tokenize(regex);
+  report("regex  ", program.size(), matched.size(), t.elapsed());
+
+  if (!same_tokens(scanned, matched)) {
+    std::cout << "token streams differ between engines!" << std::endl;
+    return 1;
+  }
+
+  std::cout << "token streams identical" << std::endl;
+  return 0;
+}
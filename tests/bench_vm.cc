@@ -0,0 +1,75 @@
+#include "ElapsedTimer.h"
+#include "Compiler.h"
+#include "Interpreter.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+#include "VM.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief: run `engine` `runs` times, changing the input `v0` every run, print the latency
+ */
+template <typename Engine>
+static void bench(const char* name, Engine& engine, int runs) {
+  uint32_t input = *engine.slotOf("v0");
+
+  std::vector<uint64_t> latencies;
+  latencies.reserve(runs);
+  letter::Value completion;
+
+  for (int i = 0; i < runs; ++i) {
+    engine.slot(input) = static_cast<double>(i);
+
+    letter::ElapsedTimer<std::chrono::nanoseconds> t(name, false);
+    completion = engine.run();
+    latencies.push_back(t.elapsed());
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  uint64_t total = 0;
+  for (auto ns : latencies) {
+    total += ns;
+  }
+
+  std::cout << name << ": " << runs << " runs, mean " << total / runs / 1000.0
+    << "(microseconds), p50 " << latencies[runs / 2] / 1000.0
+    << ", p99 " << latencies[runs * 99 / 100] / 1000.0
+    << ", completion " << completion.toString() << std::endl;
+}
+
+int main(int argc, char** argv) {
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2 * 1024;
+  int runs = argc > 2 ? std::atoi(argv[2]) : 10000;
+  bool print_disassembly = argc > 3 && std::strcmp(argv[3], "-d") == 0;
+
+  // v0 is the input of the script, set before every run
+  auto&& program = letter::generate_eval_program(size, 16, 1);
+  std::cout << "input size: " << program.size() << "(bytes)" << std::endl;
+
+  letter::Parser parser;
+  auto* ast = parser.parseAst(program);
+
+  letter::ElapsedTimer t("compile", false);
+  auto&& chunk = letter::compile(*ast, parser.symbols());
+  std::cout << "compile: " << t.elapsed() << "(microseconds), " << chunk.code.size() 
+    << " bytes of code, " << chunk.constants.size() << " constants, max stack " 
+    << chunk.max_stack << std::endl;
+
+  if (print_disassembly) {
+    std::cout << letter::disassemble(chunk);
+  }
+
+  letter::Interpreter interpreter(*ast, parser.symbols());
+  letter::VM vm(chunk);
+
+  bench("ast evaluation", interpreter, runs);
+  bench("bytecode vm", vm, runs);
+
+  return 0;
+}
@@ -0,0 +1,137 @@
+#include "json.hpp"
+
+#include "BinaryAst.h"
+#include "ElapsedTimer.h"
+#include "Exception.h"
+#include "Parser.h"
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+static int success = 0;
+static int fail = 0;
+
+static void check(bool ok, const std::string& what) {
+  if (ok) {
+    ++ success;
+  } else {
+    ++ fail;
+    std::cout << ">> test failure: " << what << std::endl;
+  }
+}
+
+/**
+ * @brief: encode the tree of `program`, decode it, it must give the same json;
+ * then parse it twice through a cache, the second parse loads the same tree from it
+ */
+static void test_a_program(const std::string& program, const json::value& result, const std::string& cache) {
+  try {
+    letter::Parser parser;
+    auto* tree = parser.parseAst(program);
+    auto&& bytes = letter::encodeBinaryAst(*tree, parser.symbols(), letter::hashSource(program), program.size());
+
+    letter::Arena arena;
+    letter::SymbolTable symbols;
+    auto* decoded = letter::BinaryAstView(bytes).decode(arena, symbols);
+    check(letter::ast::toJson(*decoded, symbols) == result, "decoded: " + program);
+
+    letter::Parser cached;
+    cached.setCacheDirectory(cache);
+    auto&& first = cached.parse(program);
+    auto&& second = cached.parse(program);
+    check(first == result && second == result && cached.cacheHit(), "cached: " + program);
+  } catch (const std::exception& e) {
+    check(false, program + ": " + e.what());
+  }
+}
+
+int main(int argc, char** argv) {
+  letter::ElapsedTimer t("md_test_binary_ast total time");
+
+  const std::string cache = (std::filesystem::temp_directory_path() / "letter_mdtest_binary_ast").string();
+  std::filesystem::remove_all(cache);
+
+  const char* filename = __ROOT__ "tests/tests.json";
+  std::ifstream ifs(filename);
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+  auto&& parse_opt = json::parse(ss.str());
+  if (!parse_opt) {
+    std::cout << "parse error: " << filename << std::endl;
+    return 1;
+  }
+
+  std::function<void(const json::value&)> test_a_json = [&](const json::value& item) {
+    if (item.find("program")) {
+      test_a_program(item.at("program").as_string(), item.at("result"), cache);
+    } else if (item.find("program_file")) {
+      std::ifstream file(item.at("program_file").as_string());
+      std::stringstream file_ss;
+      file_ss << file.rdbuf();
+      test_a_program(file_ss.str(), item.at("result"), cache);
+    } else if (item.find("sub_json")) {
+      std::ifstream sub(item.at("sub_json").as_string());
+      std::stringstream sub_ss;
+      sub_ss << sub.rdbuf();
+      if (auto&& sub_json = json::parse(sub_ss.str())) {
+        test_a_json(sub_json.value());
+      }
+    }
+  };
+  for (auto&& item : parse_opt.value()["tests_list"].as_array()) {
+    test_a_json(item);
+  }
+
+  // a changed source misses, and a damaged entry is parsed again, then replaced
+  {
+    const std::string source = "a = 1; { b = 'text' + a; }";
+    letter::Parser parser;
+    parser.setCacheDirectory(cache);
+    auto&& expected = parser.parse(source);
+    check(!parser.cacheHit(), "first parse misses");
+
+    parser.parse("a = 2; { b = 'text' + a; }");
+    check(!parser.cacheHit(), "changed source misses");
+
+    const std::string path = letter::ParseCache(cache).entryPath(letter::hashSource(source));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+    check(parser.parse(source) == expected && !parser.cacheHit(), "truncated entry misses");
+    check(parser.parse(source) == expected && parser.cacheHit(), "entry written again");
+
+    {
+      std::fstream entry(path, std::ios::binary | std::ios::in | std::ios::out);
+      entry.seekp(4);
+      entry.put('\x7f'); // another version
+    }
+    check(parser.parse(source) == expected && !parser.cacheHit(), "other version misses");
+  }
+
+  // a damaged encoding throws instead of building a broken tree
+  {
+    letter::Parser parser;
+    auto&& source = std::string("x = y * (2 + z);");
+    auto&& bytes = letter::encodeBinaryAst(*parser.parseAst(source), parser.symbols(), 0, source.size());
+    std::size_t thrown = 0;
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+      std::string damaged = bytes;
+      damaged[i] = static_cast<char>(damaged[i] + 0x41);
+      try {
+        letter::Arena arena;
+        letter::SymbolTable symbols;
+        auto* program = letter::BinaryAstView(damaged).decode(arena, symbols);
+        letter::ast::toJson(*program, symbols);
+      } catch (const letter::Exception&) {
+        ++thrown;
+      }
+    }
+    check(thrown > 0, "damaged encodings throw");
+  }
+
+  std::filesystem::remove_all(cache);
+  std::cout << "test binary ast completed\n"
+    << "> Result:\nsuccess: " << success << "\nfail: " << fail << std::endl;
+  return 0;
+}
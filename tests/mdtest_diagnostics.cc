@@ -0,0 +1,118 @@
+#include "json.hpp"
+
+#include "Diagnostic.h"
+#include "ElapsedTimer.h"
+#include "Parser.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+/**
+ * @brief: the error message of the throwing parse of `source`, empty if it parses
+ */
+static std::string throwing_error(const std::string &source) {
+  letter::Parser parser;
+  try {
+    parser.parse(source);
+    return {};
+  } catch (const std::exception &e) {
+    return e.what();
+  }
+}
+
+/**
+ * @brief: parse `program` in diagnostics mode, the partial Program must be the plain parse of
+ * `recovered`, the diagnostics those of the test, and the first one the error the throwing parse raises
+ */
+static bool test_a_program(letter::Parser &parser, const json::value &test) {
+  auto&& program = test.at("program").as_string();
+
+  try {
+    auto&& expected = parser.parse(test.at("recovered").as_string());
+
+    auto&& limit = test.find("limit");
+    letter::Diagnostics diagnostics(limit ? static_cast<std::size_t>(limit->as_integer()) :
+      letter::Diagnostics::kDefaultLimit);
+    auto&& actual = parser.parse(program, diagnostics);
+
+    if (actual != expected) {
+      std::cout << ">> test failure: " << std::endl;
+      std::cout << "program: \n\"" << program << "\"" << std::endl;
+      std::cout << "expected ast: \n" << expected.format() << std::endl;
+      std::cout << "actual ast: \n" << actual.format() << std::endl;
+      return false;
+    }
+
+    json::array list;
+    for (auto&& diagnostic : diagnostics) {
+      list.emplace_back(letter::toJson(diagnostic, program, parser.symbols()));
+    }
+    auto&& dropped = test.find("dropped");
+    if (json::value(list) != test.at("diagnostics") ||
+        diagnostics.dropped() != (dropped ? static_cast<std::size_t>(dropped->as_integer()) : 0)) {
+      std::cout << ">> test failure: diagnostics of \"" << program << "\":\n"
+                << json::value(list).format() << "\ndropped: " << diagnostics.dropped() << std::endl;
+      return false;
+    }
+
+    auto&& error = throwing_error(program);
+    auto&& first = diagnostics.empty() ? std::string() : parser.diagnosticMessage(diagnostics[0]);
+    if (first != error) {
+      std::cout << ">> test failure: \"" << program << "\" throws \"" << error
+                << "\", first diagnostic \"" << first << "\"" << std::endl;
+      return false;
+    }
+    return true;
+
+  } catch (const std::exception &e) {
+    std::cout << "exception: " << e.what() << std::endl;
+    std::cout << "when testing:\n" << test.format() << std::endl;
+    return false;
+  }
+}
+
+static void test_diagnostics() {
+  const char* filename = __ROOT__ "tests/diagnostics_tests.json";
+  std::ifstream ifs(filename);
+  if (!ifs.is_open()) {
+    std::cout << filename << " open failed" << std::endl;
+  }
+
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+
+  auto&& parse_opt = json::parse(ss.str());
+  if (!parse_opt) {
+    std::cout << "parse error: " << filename << std::endl;
+    return;
+  }
+
+  auto&& tests = parse_opt.value();
+  auto&& tests_list = tests["tests_list"].as_array();
+
+  letter::Parser parser;
+  int success = 0;
+  int fail = 0;
+
+  std::for_each(
+      tests_list.begin(), tests_list.end(), [&](const json::value &item) {
+        if (test_a_program(parser, item)) {
+          ++ success;
+        } else {
+          ++ fail;
+        }
+      });
+
+  std::cout << "test diagnostics completed\n"
+    << "> Result:\nsuccess: " << success << "\nfail: " << fail << std::endl;
+}
+
+int main(int argc, char** argv) {
+  {
+    letter::ElapsedTimer t("md_test_diagnostics total time");
+    test_diagnostics();
+  }
+  return 0;
+}
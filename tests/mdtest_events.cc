@@ -0,0 +1,180 @@
+#include "json.hpp"
+
+#include "ElapsedTimer.h"
+#include "EventParser.h"
+#include "Parser.h"
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+/**
+ * @brief: builds the json ast back from the events, to check them against the `Parser` one
+ */
+class JsonBuilder : public letter::ParseVisitor {
+private:
+  std::vector<json::array> m_lists;         // statements of the Program and the open blocks
+  std::vector<json::value> m_expressions;   // operands not taken by an operator yet
+
+public:
+  json::value result;
+
+  void onProgramBegin() override { this->m_lists.emplace_back(); }
+
+  void onProgramEnd() override {
+    this->result = json::object{{"type", "Program"}, {"body", this->m_lists.back()}};
+    this->m_lists.pop_back();
+  }
+
+  void onStatementBegin(letter::ast::NodeType type) override {
+    if (type == letter::ast::NodeType::BlockStatement) {
+      this->m_lists.emplace_back();
+    }
+  }
+
+  void onStatementEnd(letter::ast::NodeType type) override {
+    json::value statement;
+    switch (type) {
+    case letter::ast::NodeType::ExpressionStatement:
+      statement = json::object{{"type", "ExpressionStatement"}, {"expression", this->_pop()}};
+      break;
+    case letter::ast::NodeType::BlockStatement:
+      statement = json::object{{"type", "BlockStatement"}, {"body", this->m_lists.back()}};
+      this->m_lists.pop_back();
+      break;
+    default:
+      statement = json::object{{"type", "EmptyStatement"}};
+      break;
+    }
+    this->m_lists.back().emplace_back(std::move(statement));
+  }
+
+  void onBinaryExpression(letter::ast::Operator op) override { this->_operator("BinaryExpression", op); }
+
+  void onAssignmentExpression(letter::ast::Operator op) override { this->_operator("AssignmentExpression", op); }
+
+  void onIdentifier(std::string_view name) override {
+    this->m_expressions.emplace_back(json::object{{"type", "Identifier"}, {"name", std::string(name)}});
+  }
+
+  void onNumericLiteral(letter::NumberValue value) override {
+    this->m_expressions.emplace_back(json::object{{"type", "NumericLiteral"},
+      {"value", value.isReal() ? json::value(value.real) : json::value(static_cast<long long>(value.integer))}});
+  }
+
+  void onStringLiteral(std::string_view value) override {
+    this->m_expressions.emplace_back(json::object{{"type", "StringLiteral"}, {"value", std::string(value)}});
+  }
+
+private:
+  json::value _pop() {
+    auto value = std::move(this->m_expressions.back());
+    this->m_expressions.pop_back();
+    return value;
+  }
+
+  void _operator(const char* type, letter::ast::Operator op) {
+    auto right = this->_pop();
+    auto left = this->_pop();
+    this->m_expressions.emplace_back(json::object{
+      {"type", type}, {"operator", letter::ast::operatorText(op)}, {"left", left}, {"right", right}});
+  }
+};
+
+/**
+ * @brief: the json ast rebuilt from the events of `parse`, or the error message
+ */
+static std::string from_events(const std::function<void(letter::EventParser&, letter::ParseVisitor&)>& parse) {
+  letter::EventParser parser;
+  JsonBuilder builder;
+  try {
+    parse(parser, builder);
+    return builder.result.to_string();
+  } catch (const std::exception &e) {
+    return e.what();
+  }
+}
+
+int main(int argc, char** argv) {
+  letter::ElapsedTimer t("md_test_events total time");
+
+  const char* filename = __ROOT__ "tests/tests.json";
+  std::ifstream ifs(filename);
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+
+  auto&& parse_opt = json::parse(ss.str());
+  if (!parse_opt) {
+    std::cout << "parse error: " << filename << std::endl;
+    return 1;
+  }
+
+  int success = 0;
+  int fail = 0;
+  auto&& check = [&](const std::string& what, const std::string& actual, const std::string& expected) {
+    if (actual == expected) {
+      ++ success;
+    } else {
+      ++ fail;
+      std::cout << ">> test failure: " << what << "\nexpected: " << expected << "\nactual: " << actual << std::endl;
+    }
+  };
+
+  // every case of tests.json, sources in place and files from their mapping
+  std::function<void(const json::value&)> test_a_json = [&](const json::value& item) {
+    if (item.find("program")) {
+      auto&& program = item.at("program").as_string();
+      check(program, from_events([&](letter::EventParser& parser, letter::ParseVisitor& visitor) {
+        parser.parse(program, visitor);
+      }), item.at("result").to_string());
+    } else if (item.find("program_file")) {
+      auto&& path = item.at("program_file").as_string();
+      check(path, from_events([&](letter::EventParser& parser, letter::ParseVisitor& visitor) {
+        parser.parseFile(path, visitor);
+      }), item.at("result").to_string());
+    } else if (item.find("sub_json")) {
+      std::ifstream sub(item.at("sub_json").as_string());
+      std::stringstream sub_ss;
+      sub_ss << sub.rdbuf();
+      if (auto&& sub_json = json::parse(sub_ss.str())) {
+        test_a_json(sub_json.value());
+      }
+    }
+  };
+  for (auto&& item : parse_opt.value()["tests_list"].as_array()) {
+    test_a_json(item);
+  }
+
+  // errors must be the ones of `Parser`
+  static const char* const s_errors[] = {
+    "x = ;",
+    "a = 1; { b = 2; ",
+    "a = 1; } ",
+    "(a + 1) = 2;",
+    "a = (b = 1) = 2;",
+    "1 += 2;",
+    "x = y + 2 /* c */ = 3;",
+    "a = 1; ((a)) * 'b' // c\n = 1; z = ;",
+    "x = 'open;",
+    "a b;",
+    "(a;",
+  };
+  for (auto* source : s_errors) {
+    std::string expected;
+    try {
+      letter::Parser parser;
+      expected = parser.parse(source).to_string();
+    } catch (const std::exception &e) {
+      expected = e.what();
+    }
+    check(source, from_events([&](letter::EventParser& parser, letter::ParseVisitor& visitor) {
+      parser.parse(source, visitor);
+    }), expected);
+  }
+
+  std::cout << "test events completed\n"
+    << "> Result:\nsuccess: " << success << "\nfail: " << fail << std::endl;
+  return 0;
+}
@@ -0,0 +1,128 @@
+#include "json.hpp"
+
+#include "ElapsedTimer.h"
+#include "Compiler.h"
+#include "Interpreter.h"
+#include "Optimizer.h"
+#include "Parser.h"
+#include "VM.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static letter::Value to_value(const json::value& value) {
+  if (value.is_string()) {
+    return value.as_string();
+  }
+  return value.as_double();
+}
+
+/**
+ * @brief: run `test` on the tree-walking `Interpreter` or on the bytecode `VM`
+ */
+template <typename Engine>
+static letter::Value run(Engine& engine, const json::value &test) {
+  if (auto&& variables = test.find("variables")) {
+    for (auto&& [name, value] : variables->as_object()) {
+      engine.setVariable(name, to_value(value));
+    }
+  }
+  return engine.run();
+}
+
+static bool test_a_program(letter::Parser &parser, const json::value &test, bool use_vm, bool optimized) {
+  auto&& program = test.at("program").as_string();
+
+  try {
+    auto* ast = parser.parseAst(program);
+    if (optimized) {
+      letter::optimize(*ast, parser.arena(), parser.symbols());
+    }
+    letter::Value completion;
+
+    if (use_vm) {
+      auto&& chunk = letter::compile(*ast, parser.symbols());
+      letter::VM vm(chunk);
+      completion = run(vm, test);
+    } else {
+      letter::Interpreter interpreter(*ast, parser.symbols());
+      completion = run(interpreter, test);
+    }
+
+    if (test.find("error")) {
+      std::cout << ">> test failure: expected error: " << test.at("error").as_string()
+                << "\nprogram: \"" << program << "\"" << std::endl;
+      return false;
+    }
+
+    auto&& expected = to_value(test.at("completion"));
+    if (completion != expected) {
+      std::cout << ">> test failure" << (use_vm ? " (vm)" : "") << (optimized ? " (optimized)" : "")
+                << ": " << std::endl;
+      std::cout << "program: \n\"" << program << "\"" << std::endl;
+      std::cout << "expected completion: " << expected.toString() << std::endl;
+      std::cout << "actual completion: " << completion.toString() << std::endl;
+      return false;
+    }
+    return true;
+
+  } catch (const std::exception &e) {
+    if (auto&& error = test.find("error"); error && error->as_string() == e.what()) {
+      return true;
+    }
+    std::cout << "exception: " << e.what() << std::endl;
+    std::cout << "when testing:\n" << test.format() << std::endl;
+    return false;
+  }
+}
+
+static void test_interpreter() {
+  const char* filename = __ROOT__ "tests/interpreter_tests.json";
+  std::ifstream ifs(filename);
+  if (!ifs.is_open()) {
+    std::cout << filename << " open failed" << std::endl;
+  }
+
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+
+  auto&& parse_opt = json::parse(ss.str());
+  if (!parse_opt) {
+    std::cout << "parse error: " << filename << std::endl;
+    return;
+  }
+
+  auto&& tests = parse_opt.value();
+  auto&& tests_list = tests["tests_list"].as_array();
+
+  int success = 0;
+  int fail = 0;
+
+  letter::Parser parser;
+  std::for_each(
+      tests_list.begin(), tests_list.end(), [&](const json::value &item) {
+        // every program runs on both engines, as parsed and optimized
+        for (bool use_vm : {false, true}) {
+          for (bool optimized : {false, true}) {
+            if (test_a_program(parser, item, use_vm, optimized)) {
+              ++ success;
+            } else {
+              ++ fail;
+            }
+          }
+        }
+      });
+
+  std::cout << "test interpreter completed\n"
+    << "> Result:\nsuccess: " << success << "\nfail: " << fail << std::endl;
+}
+
+int main(int argc, char** argv) {
+  {
+    letter::ElapsedTimer t("md_test_interpreter total time");
+    test_interpreter();
+  }
+  return 0;
+}
@@ -0,0 +1,154 @@
+#include "json.hpp"
+
+#include "Ast.h"
+#include "ElapsedTimer.h"
+#include "JsonWriter.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief: `source` written by a JsonWriter in every mode must be what the json library prints
+ */
+static bool test_a_source(const std::string& source, bool locations) {
+  letter::Parser parser;
+  parser.setLocations(locations);
+  auto* program = parser.parseAst(source);
+  const letter::LineIndex* lines = locations ? &parser.lineIndex() : nullptr;
+  auto&& tree = letter::ast::toJson(*program, parser.symbols(), lines);
+
+  for (bool pretty : {false, true}) {
+    const std::string expected = pretty ? tree.format() : tree.to_string();
+    // a buffer of a few bytes flushes in the middle of every token
+    for (std::size_t buffer_size : {letter::JsonWriter::kBufferSize, std::size_t(7)}) {
+      std::ostringstream out;
+      {
+        letter::JsonWriter writer(out, pretty, buffer_size);
+        writer.writeAst(*program, parser.symbols(), lines);
+        writer.flush();
+        if (writer.written() != expected.size()) {
+          std::cout << ">> test failure: written " << writer.written() << " of " << expected.size() << std::endl;
+          return false;
+        }
+      }
+      if (out.str() != expected) {
+        std::cout << ">> test failure: " << (pretty ? "pretty" : "compact") << ", buffer " << buffer_size
+                  << ", of \"" << source << "\":\n" << out.str() << "\nexpected:\n" << expected << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  letter::ElapsedTimer t("md_test_json_writer total time");
+
+  const char* filename = __ROOT__ "tests/tests.json";
+  std::ifstream ifs(filename);
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+
+  auto&& parse_opt = json::parse(ss.str());
+  if (!parse_opt) {
+    std::cout << "parse error: " << filename << std::endl;
+    return 1;
+  }
+
+  int success = 0;
+  int fail = 0;
+  auto&& check = [&](bool ok) {
+    if (ok) {
+      ++ success;
+    } else {
+      ++ fail;
+    }
+  };
+
+  // every case of tests.json, with and without locations
+  std::vector<std::string> sources;
+  std::function<void(const json::value&)> collect = [&](const json::value& item) {
+    if (item.find("program")) {
+      sources.emplace_back(item.at("program").as_string());
+    } else if (item.find("program_file")) {
+      std::ifstream file(item.at("program_file").as_string());
+      std::stringstream file_ss;
+      file_ss << file.rdbuf();
+      sources.emplace_back(file_ss.str());
+    } else if (item.find("sub_json")) {
+      std::ifstream sub(item.at("sub_json").as_string());
+      std::stringstream sub_ss;
+      sub_ss << sub.rdbuf();
+      if (auto&& sub_json = json::parse(sub_ss.str())) {
+        collect(sub_json.value());
+      }
+    }
+  };
+  for (auto&& item : parse_opt.value()["tests_list"].as_array()) {
+    collect(item);
+  }
+
+  // strings to escape, reals, empty lists, and a generated program of every token class
+  sources.emplace_back("s = 'a \"quoted\" \\\\ back\tslash\nline'; \"it's\";");
+  sources.emplace_back("x = 2.5 * 1e-3 + 0x7fffffffffffffff; ;");
+  sources.emplace_back("{ } { { } ; }");
+  sources.emplace_back(letter::generate_program(64 * 1024));
+  for (auto&& source : sources) {
+    check(test_a_source(source, false));
+    check(test_a_source(source, true));
+  }
+
+  // a file descriptor, flushed on destruction
+  {
+    const std::string source = letter::generate_program(200 * 1024);
+    letter::Parser parser;
+    auto* program = parser.parseAst(source);
+    std::FILE* file = std::tmpfile();
+    {
+      letter::JsonWriter writer(fileno(file), true);
+      writer.writeAst(*program, parser.symbols());
+    }
+    std::string written;
+    std::rewind(file);
+    char chunk[4096];
+    for (std::size_t n; (n = std::fread(chunk, 1, sizeof(chunk), file)) > 0; ) {
+      written.append(chunk, n);
+    }
+    std::fclose(file);
+    const bool same = written == letter::ast::toJson(*program, parser.symbols()).format();
+    if (!same) {
+      std::cout << ">> test failure: written to a file descriptor" << std::endl;
+    }
+    check(same);
+  }
+
+  // a write error is thrown by `flush`
+  {
+    letter::Parser parser;
+    auto* program = parser.parseAst("x = 1;");
+    std::string error;
+    try {
+      letter::JsonWriter writer(-1);
+      writer.writeAst(*program, parser.symbols());
+      writer.flush();
+    } catch (const std::exception& e) {
+      error = e.what();
+    }
+    const bool thrown = error == "Cannot write json: Bad file descriptor";
+    if (!thrown) {
+      std::cout << ">> test failure: writing to a bad file descriptor gives \"" << error << "\"" << std::endl;
+    }
+    check(thrown);
+  }
+
+  std::cout << "test json writer completed\n"
+    << "> Result:\nsuccess: " << success << "\nfail: " << fail << std::endl;
+  return 0;
+}
@@ -0,0 +1,184 @@
+#include "json.hpp"
+
+#include "Ast.h"
+#include "ElapsedTimer.h"
+#include "Parser.h"
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+/**
+ * @brief: the json ast of an eager parse of `source`, or the error message
+ */
+static std::string eager_parse(const std::string &source) {
+  letter::Parser parser;
+  try {
+    return parser.parse(source).to_string();
+  } catch (const std::exception &e) {
+    return e.what();
+  }
+}
+
+/**
+ * @brief: the json ast of a lazy parse of `source`, every body parsed by the conversion, or the error message
+ */
+static std::string lazy_parse(const std::string &source) {
+  letter::Parser parser;
+  parser.setLazyBlocks(true);
+  try {
+    return parser.parse(source).to_string();
+  } catch (const std::exception &e) {
+    return e.what();
+  }
+}
+
+int main(int argc, char** argv) {
+  letter::ElapsedTimer t("md_test_lazy total time");
+
+  const char* filename = __ROOT__ "tests/tests.json";
+  std::ifstream ifs(filename);
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+
+  auto&& parse_opt = json::parse(ss.str());
+  if (!parse_opt) {
+    std::cout << "parse error: " << filename << std::endl;
+    return 1;
+  }
+
+  int success = 0;
+  int fail = 0;
+  auto&& check = [&](const std::string& what, bool ok) {
+    if (ok) {
+      ++ success;
+    } else {
+      ++ fail;
+      std::cout << ">> test failure: " << what << std::endl;
+    }
+  };
+
+  // every case of tests.json, bodies parsed on demand give the eager tree
+  std::function<void(const json::value&)> test_a_json = [&](const json::value& item) {
+    if (item.find("program")) {
+      auto&& program = item.at("program").as_string();
+      check(program, lazy_parse(program) == item.at("result").to_string());
+    } else if (item.find("program_file")) {
+      std::ifstream file(item.at("program_file").as_string());
+      std::stringstream file_ss;
+      file_ss << file.rdbuf();
+      check(item.at("program_file").as_string(), lazy_parse(file_ss.str()) == item.at("result").to_string());
+    } else if (item.find("sub_json")) {
+      std::ifstream sub(item.at("sub_json").as_string());
+      std::stringstream sub_ss;
+      sub_ss << sub.rdbuf();
+      if (auto&& sub_json = json::parse(sub_ss.str())) {
+        test_a_json(sub_json.value());
+      }
+    }
+  };
+  for (auto&& item : parse_opt.value()["tests_list"].as_array()) {
+    test_a_json(item);
+  }
+
+  // braces in strings and comments, and blocks the pre-scan can not close, which fail as they do eagerly
+  static const char* const s_sources[] = {
+    "{ s = '}'; t = \"{\"; /* } */ // }\n u; } v;",
+    "{ { { a; } } { } b; } c;",
+    "{ a = 1 / 2; /* unclosed } ",
+    "a = 1; { b = 2; ",
+    "{ s = 'open; } x;",
+    "a = 1; } ",
+    "x = { y; };",
+  };
+  for (auto* source : s_sources) {
+    check(source, lazy_parse(source) == eager_parse(source));
+  }
+
+  // an error in a body is thrown when the body is parsed, every time until it parses
+  {
+    const std::string source = "a = 1; { b = 2; { c = ; } } d;";
+    letter::Parser parser;
+    parser.setLazyBlocks(true);
+    auto* program = parser.parseAst(source);
+    check("lazy parse of an invalid body", program->body.size == 3);
+
+    auto* outer = letter::ast::cast<letter::ast::BlockStatement>(program->body[1]);
+    auto&& body = outer->statements();
+    auto* inner = letter::ast::cast<letter::ast::BlockStatement>(body[1]);
+    check("nested bodies stay lazy", !outer->lazy && body.size == 2 && inner->lazy);
+
+    const std::string expected = eager_parse(source);
+    for (int i = 0; i < 2; ++i) {
+      std::string error;
+      try {
+        inner->statements();
+      } catch (const std::exception &e) {
+        error = e.what();
+      }
+      check("forced body throws \"" + expected + "\", not \"" + error + "\"", error == expected && inner->lazy);
+    }
+
+    std::string error;
+    try {
+      parser.validate(*parser.parseAst(source));
+    } catch (const std::exception &e) {
+      error = e.what();
+    }
+    check("validate throws \"" + expected + "\", not \"" + error + "\"", error == expected);
+  }
+
+  // a body is parsed with the settings of the parse which skipped it, and a read only tree is never parsed
+  {
+    letter::Parser parser;
+    parser.setLazyBlocks(true);
+    parser.setLocations(true);
+    auto* program = parser.parseAst("x = 1;\n{ a = 1; { b; } }");
+    parser.setLocations(false);
+    parser.setLazyBlocks(false);
+    auto* block = letter::ast::cast<letter::ast::BlockStatement>(program->body[1]);
+
+    std::string error;
+    try {
+      static_cast<const letter::ast::BlockStatement*>(block)->statements();
+    } catch (const std::exception &e) {
+      error = e.what();
+    }
+    check("const statements() of a lazy body throws, not \"" + error + "\"", !error.empty() && block->lazy);
+
+    auto&& body = block->statements();
+    auto* inner = letter::ast::cast<letter::ast::BlockStatement>(body[1]);
+    check("lazy body located as its parse", block->span.offset == 7 && block->span.length == 17 &&
+      body[0]->span.offset == 9 && body[0]->span.length == 6 && inner->lazy && inner->lazy->locations);
+  }
+
+  // a released tree has every body parsed, by the source it was parsed from
+  {
+    const std::string source = "a = 1; { b = 'x'; { c = b * 2; } } d;";
+    letter::Parser parser;
+    parser.setLazyBlocks(true);
+    auto* program = parser.parseAst(source);
+    letter::Arena arena;
+    letter::SymbolTable symbols;
+    parser.release(arena, symbols);
+    parser.parseAst("{ other = 'source'; { x; } }");
+    auto* block = letter::ast::cast<letter::ast::BlockStatement>(program->body[1]);
+    check("released bodies are parsed", !block->lazy && 
+      letter::ast::toJson(*program, symbols).to_string() == eager_parse(source));
+
+    const std::string broken = "a = 1; { b = ; }";
+    parser.parseAst(broken);
+    std::string error;
+    try {
+      parser.release(arena, symbols);
+    } catch (const std::exception &e) {
+      error = e.what();
+    }
+    check("release throws \"" + eager_parse(broken) + "\", not \"" + error + "\"", error == eager_parse(broken));
+  }
+
+  std::cout << "test lazy completed\n"
+    << "> Result:\nsuccess: " << success << "\nfail: " << fail << std::endl;
+  return 0;
+}
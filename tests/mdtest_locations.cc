@@ -0,0 +1,195 @@
+#include "json.hpp"
+
+#include "Ast.h"
+#include "ElapsedTimer.h"
+#include "Parser.h"
+#include "SourceLocation.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+/**
+ * @brief: [type, text of its span] of every node, in preorder
+ */
+static void collect_spans(const letter::ast::Node* node, std::string_view source, json::array& out) {
+  using namespace letter::ast;
+  out.emplace_back(json::array{nodeTypeName(node->type),
+    std::string(source.substr(node->span.offset, node->span.length))});
+
+  switch (node->type) {
+  case NodeType::Program:
+    for (auto* statement : static_cast<const Program*>(node)->body) {
+      collect_spans(statement, source, out);
+    }
+    break;
+  case NodeType::BlockStatement:
+    for (auto* statement : static_cast<const BlockStatement*>(node)->statements()) {
+      collect_spans(statement, source, out);
+    }
+    break;
+  case NodeType::ExpressionStatement:
+    collect_spans(static_cast<const ExpressionStatement*>(node)->expression, source, out);
+    break;
+  case NodeType::AssignmentExpression:
+    collect_spans(static_cast<const AssignmentExpression*>(node)->left, source, out);
+    collect_spans(static_cast<const AssignmentExpression*>(node)->right, source, out);
+    break;
+  case NodeType::BinaryExpression:
+    collect_spans(static_cast<const BinaryExpression*>(node)->left, source, out);
+    collect_spans(static_cast<const BinaryExpression*>(node)->right, source, out);
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief: the json with "loc" of a full, serial parse of `source`
+ */
+static json::value located_parse(const std::string &source) {
+  letter::Parser parser;
+  parser.setLocations(true);
+  return parser.parse(source);
+}
+
+/**
+ * @brief: the spans of `program` must be those of the test, its positions those of its line index,
+ * and a parallel parse and every reparse of its edits must locate as a full parse does
+ */
+static bool test_a_program(const json::value &test) {
+  std::string source = test.at("program").as_string();
+
+  try {
+    letter::Parser parser;
+    parser.setLocations(true);
+    auto* program = parser.parseAst(source);
+
+    json::array spans;
+    collect_spans(program, source, spans);
+    if (json::value(spans) != test.at("spans")) {
+      std::cout << ">> test failure: spans of \"" << source << "\":\n" << json::value(spans).format() << std::endl;
+      return false;
+    }
+
+    for (auto&& item : test.at("positions").as_array()) {
+      auto&& position = parser.position(static_cast<uint32_t>(item.at(0).as_integer()));
+      if (static_cast<int>(position.line) != item.at(1).as_integer() ||
+          static_cast<int>(position.column) != item.at(2).as_integer()) {
+        std::cout << ">> test failure: \"" << source << "\" offset " << item.at(0).as_integer() << " is at "
+                  << position.line << ":" << position.column << std::endl;
+        return false;
+      }
+    }
+
+    auto&& expected = located_parse(source);
+    letter::Parser parallel;
+    parallel.setLocations(true);
+    parallel.setThreads(4, 1);
+    if (parallel.parse(source) != expected) {
+      std::cout << ">> test failure: parallel parse of \"" << source << "\" locates otherwise" << std::endl;
+      return false;
+    }
+
+    letter::Parser incremental;
+    incremental.setLocations(true);
+    incremental.setIncremental(true);
+    incremental.parse(source);
+    if (auto&& edits = test.find("edits")) {
+      for (auto&& item : edits->as_array()) {
+        letter::TextEdit edit{static_cast<std::size_t>(item.at("offset").as_integer()),
+          static_cast<std::size_t>(item.at("removed").as_integer()), item.at("inserted").as_string()};
+        auto&& actual = incremental.reparse(edit);
+        source.replace(edit.offset, edit.removed, edit.inserted);
+        if (actual != located_parse(source)) {
+          std::cout << ">> test failure: reparse of \"" << source << "\" locates otherwise:\n"
+                    << actual.format() << std::endl;
+          return false;
+        }
+      }
+    }
+    return true;
+
+  } catch (const std::exception &e) {
+    std::cout << "exception: " << e.what() << std::endl;
+    std::cout << "when testing:\n" << test.format() << std::endl;
+    return false;
+  }
+}
+
+static void test_locations() {
+  const char* filename = __ROOT__ "tests/locations_tests.json";
+  std::ifstream ifs(filename);
+  if (!ifs.is_open()) {
+    std::cout << filename << " open failed" << std::endl;
+  }
+
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+
+  auto&& parse_opt = json::parse(ss.str());
+  if (!parse_opt) {
+    std::cout << "parse error: " << filename << std::endl;
+    return;
+  }
+
+  auto&& tests = parse_opt.value();
+  auto&& tests_list = tests["tests_list"].as_array();
+
+  int success = 0;
+  int fail = 0;
+
+  std::for_each(
+      tests_list.begin(), tests_list.end(), [&](const json::value &item) {
+        if (test_a_program(item)) {
+          ++ success;
+        } else {
+          ++ fail;
+        }
+      });
+
+  // every kernel builds the same index
+  const std::string text = "a;\r\nb;\rc;\n\nd;" + std::string(100, ' ') + "\n\r\n" + std::string(70, 'x');
+  const letter::LineIndex reference(text, letter::scanKernels(letter::ScanIsa::Scalar));
+  for (auto isa : {letter::ScanIsa::SSE2, letter::ScanIsa::AVX2}) {
+    const letter::LineIndex index(text, letter::scanKernels(isa));
+    bool same = index.lines() == reference.lines() && reference.lines() == 7;
+    for (uint32_t offset = 0; same && offset <= text.size(); ++offset) {
+      same = index.position(offset).line == reference.position(offset).line &&
+        index.position(offset).column == reference.position(offset).column;
+    }
+    if (same) {
+      ++ success;
+    } else {
+      std::cout << ">> test failure: line index of " << letter::scanIsaName(isa) << std::endl;
+      ++ fail;
+    }
+  }
+
+  // a source large enough to be cut: the parts are located in their own text, then moved
+  std::string large;
+  for (int i = 0; i < 500; ++i) {
+    large += "v" + std::to_string(i) + " = (a + " + std::to_string(i) + ") * b;\n{ 'block'; }\n";
+  }
+  letter::Parser parallel;
+  parallel.setLocations(true);
+  parallel.setThreads(4, 1);
+  if (parallel.parse(large) == located_parse(large)) {
+    ++ success;
+  } else {
+    std::cout << ">> test failure: parallel parse of a large source locates otherwise" << std::endl;
+    ++ fail;
+  }
+
+  std::cout << "test locations completed\n"
+    << "> Result:\nsuccess: " << success << "\nfail: " << fail << std::endl;
+}
+
+int main(int argc, char** argv) {
+  {
+    letter::ElapsedTimer t("md_test_locations total time");
+    test_locations();
+  }
+  return 0;
+}
@@ -0,0 +1,107 @@
+#include "json.hpp"
+
+#include "ElapsedTimer.h"
+#include "Optimizer.h"
+#include "Parser.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static std::size_t expected_count(const json::value &test, const std::string &key) {
+  auto&& count = test.find(key);
+  return count ? static_cast<std::size_t>(count->as_integer()) : 0;
+}
+
+/**
+ * @brief: optimize `program`, then compare with the plain parse of `optimized`,
+ * with the counters, and check that a second run changes nothing
+ */
+static bool test_a_program(letter::Parser &parser, const json::value &test) {
+  auto&& program = test.at("program").as_string();
+
+  try {
+    auto&& expected = parser.parse(test.at("optimized").as_string());
+
+    auto* ast = parser.parseAst(program);
+    auto&& stats = letter::optimize(*ast, parser.arena(), parser.symbols());
+    auto&& actual = letter::ast::toJson(*ast, parser.symbols());
+
+    if (actual != expected) {
+      std::cout << ">> test failure: " << std::endl;
+      std::cout << "program: \n\"" << program << "\"" << std::endl;
+      std::cout << "expected ast: \n" << expected.format() << std::endl;
+      std::cout << "actual ast: \n" << actual.format() << std::endl;
+      return false;
+    }
+
+    if (stats.folded_expressions != expected_count(test, "folded") ||
+        stats.lowered_assignments != expected_count(test, "lowered") ||
+        stats.removed_statements != expected_count(test, "removed") ||
+        stats.removed_nodes != expected_count(test, "removed_nodes") ||
+        stats.added_nodes != 2 * stats.lowered_assignments) {
+      std::cout << ">> test failure: counters of \"" << program << "\": folded "
+                << stats.folded_expressions << ", lowered " << stats.lowered_assignments
+                << ", removed " << stats.removed_statements << ", removed_nodes "
+                << stats.removed_nodes << ", added_nodes " << stats.added_nodes << std::endl;
+      return false;
+    }
+
+    auto&& again = letter::optimize(*ast, parser.arena(), parser.symbols());
+    if (again.changed() || letter::ast::toJson(*ast, parser.symbols()) != expected) {
+      std::cout << ">> test failure: second optimization changed \"" << program << "\"" << std::endl;
+      return false;
+    }
+    return true;
+
+  } catch (const std::exception &e) {
+    std::cout << "exception: " << e.what() << std::endl;
+    std::cout << "when testing:\n" << test.format() << std::endl;
+    return false;
+  }
+}
+
+static void test_optimizer() {
+  const char* filename = __ROOT__ "tests/optimizer_tests.json";
+  std::ifstream ifs(filename);
+  if (!ifs.is_open()) {
+    std::cout << filename << " open failed" << std::endl;
+  }
+
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+
+  auto&& parse_opt = json::parse(ss.str());
+  if (!parse_opt) {
+    std::cout << "parse error: " << filename << std::endl;
+    return;
+  }
+
+  auto&& tests = parse_opt.value();
+  auto&& tests_list = tests["tests_list"].as_array();
+
+  int success = 0;
+  int fail = 0;
+
+  letter::Parser parser;
+  std::for_each(
+      tests_list.begin(), tests_list.end(), [&](const json::value &item) {
+        if (test_a_program(parser, item)) {
+          ++ success;
+        } else {
+          ++ fail;
+        }
+      });
+
+  std::cout << "test optimizer completed\n"
+    << "> Result:\nsuccess: " << success << "\nfail: " << fail << std::endl;
+}
+
+int main(int argc, char** argv) {
+  {
+    letter::ElapsedTimer t("md_test_optimizer total time");
+    test_optimizer();
+  }
+  return 0;
+}
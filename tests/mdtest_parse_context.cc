@@ -0,0 +1,165 @@
+#include "json.hpp"
+
+#include "Ast.h"
+#include "Diagnostic.h"
+#include "ElapsedTimer.h"
+#include "Instrument.h"
+#include "ParseContext.h"
+#include "Parser.h"
+#include "ProgramGenerator.h"
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+/**
+ * @brief: the json ast of a fresh parse of `source`, or the error message
+ */
+static std::string fresh_parse(const std::string &source) {
+  letter::Parser parser;
+  try {
+    return parser.parse(source).to_string();
+  } catch (const std::exception &e) {
+    return e.what();
+  }
+}
+
+/**
+ * @brief: the json ast of a parse of `source` by a context used before, or the error message
+ */
+static std::string context_parse(letter::ParseContext& context, const std::string &source) {
+  try {
+    return letter::ast::toJson(*context.parse(source), context.symbols()).to_string();
+  } catch (const std::exception &e) {
+    return e.what();
+  }
+}
+
+/**
+ * @brief: the json ast and the messages of a diagnosing parse of `source`
+ */
+static std::string diagnosed(letter::ast::Program* program, const letter::SymbolTable& symbols,
+    const letter::Diagnostics& diagnostics, const std::function<std::string(const letter::Diagnostic&)>& message) {
+  std::string text = letter::ast::toJson(*program, symbols).to_string();
+  for (auto&& diagnostic : diagnostics) {
+    text += "\n" + message(diagnostic);
+  }
+  return text;
+}
+
+int main(int argc, char** argv) {
+  letter::ElapsedTimer t("md_test_parse_context total time");
+
+  const char* filename = __ROOT__ "tests/tests.json";
+  std::ifstream ifs(filename);
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+
+  auto&& parse_opt = json::parse(ss.str());
+  if (!parse_opt) {
+    std::cout << "parse error: " << filename << std::endl;
+    return 1;
+  }
+
+  int success = 0;
+  int fail = 0;
+  auto&& check = [&](const std::string& what, bool ok) {
+    if (ok) {
+      ++ success;
+    } else {
+      ++ fail;
+      std::cout << ">> test failure: " << what << std::endl;
+    }
+  };
+
+  // one context for every case of tests.json, errors included, each parse gives the tree of a fresh parser
+  letter::ParseContext context;
+  std::function<void(const json::value&)> test_a_json = [&](const json::value& item) {
+    if (item.find("program")) {
+      auto&& program = item.at("program").as_string();
+      check(program, context_parse(context, program) == fresh_parse(program));
+    } else if (item.find("program_file")) {
+      std::ifstream file(item.at("program_file").as_string());
+      std::stringstream file_ss;
+      file_ss << file.rdbuf();
+      check(item.at("program_file").as_string(), context_parse(context, file_ss.str()) == fresh_parse(file_ss.str()));
+    } else if (item.find("sub_json")) {
+      std::ifstream sub(item.at("sub_json").as_string());
+      std::stringstream sub_ss;
+      sub_ss << sub.rdbuf();
+      if (auto&& sub_json = json::parse(sub_ss.str())) {
+        test_a_json(sub_json.value());
+      }
+    }
+  };
+  for (auto&& item : parse_opt.value()["tests_list"].as_array()) {
+    test_a_json(item);
+  }
+
+  // snippets, with a syntax error between two of them, and after a reset
+  auto&& snippets = letter::generate_snippets(200);
+  bool same = true;
+  for (std::size_t i = 0; i < snippets.size(); ++i) {
+    if (i % 50 == 25) {
+      same = context_parse(context, "a = ;") == fresh_parse("a = ;") && same;
+    }
+    if (i == 100) {
+      context.reset();
+      same = context.source().empty() && context.symbols().size() == 0 && same;
+    }
+    same = context_parse(context, snippets[i]) == fresh_parse(snippets[i]) && same;
+  }
+  check("snippets parse as with a fresh parser", same);
+
+  // diagnosing parses record what a fresh parser records
+  static const char* const s_broken[] = {
+    "a = ; b = 1;",
+    "x = (1 + ; y;",
+    "'unterminated",
+    "c = 0x;",
+  };
+  letter::Diagnostics diagnostics;
+  for (auto* source : s_broken) {
+    letter::Parser parser;
+    letter::Diagnostics expected_diagnostics;
+    auto&& expected = diagnosed(parser.parseAst(source, expected_diagnostics), parser.symbols(), expected_diagnostics,
+      [&](const letter::Diagnostic& d) { return parser.diagnosticMessage(d); });
+    auto* program = context.parse(source, diagnostics);
+    auto&& actual = diagnosed(program, context.symbols(), diagnostics,
+      [&](const letter::Diagnostic& d) { return context.diagnosticMessage(d); });
+    check(std::string("diagnosing parse of \"") + source + "\": " + actual, actual == expected);
+  }
+
+  // in steady state, the memory is the same parse after parse and nothing is allocated
+  {
+    letter::ParseContext warm;
+    for (auto&& snippet : snippets) {
+      warm.parse(snippet);
+      warm.parse(snippet, diagnostics);
+    }
+    const std::size_t reserved = warm.bytesReserved();
+    letter::instrument::reset();
+    for (int round = 0; round < 10; ++round) {
+      for (auto&& snippet : snippets) {
+        warm.parse(snippet);
+        warm.parse(snippet, diagnostics);
+      }
+    }
+    // taken first, the messages of `check` allocate
+    auto&& stats = letter::instrument::snapshot();
+    check("arena memory grows in steady state", warm.bytesReserved() == reserved);
+    if (letter::instrument::kEnabled) {
+      uint64_t allocations = 0;
+      for (auto&& phase : stats.phases) {
+        allocations += phase.count;
+      }
+      check(std::to_string(allocations) + " allocations in steady state", allocations == 0);
+    }
+    check("parses counted", warm.parses() == snippets.size() * 22);
+  }
+
+  std::cout << "test parse context completed\n"
+    << "> Result:\nsuccess: " << success << "\nfail: " << fail << std::endl;
+  return 0;
+}
@@ -2,11 +2,14 @@
 
 #include "ElapsedTimer.h"
 #include "Exception.h"
+#include "Instrument.h"
+#include "ParseMany.h"
 #include "Parser.h"
 #include "Tokenizer.h"
 #include <algorithm>
 #include <assert.h>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <ostream>
 #include <sstream>
@@ -39,21 +42,25 @@ static bool test_a_program(letter::Parser &parser,
 
 static bool test_a_program_file(letter::Parser &parser,
                                 const std::string &filename, const json::value& result) {
-  std::ifstream ifs(filename);
-  if (!ifs.is_open()) {
-    std::cout << filename << " open failed" << std::endl;
-    return false;
-  }
+  try {
+    auto &&parse_result = parser.parseFile(filename);
 
-  std::stringstream ss;
-  ss << ifs.rdbuf();
+    if (parse_result != result) {
+      std::cout << ">> test failure: " << std::endl;
+      std::cout << "program_file: " << filename << std::endl;
+      std::cout << "expected res:\n"
+                << result.format(true) << std::endl;
+      std::cout << "actual res:\n" << parse_result.format(true) << std::endl;
+      return false;
+    } else {
+      return true;
+    }
 
-  auto&& t = json::object{
-    {"program", ss.str()},
-    {"result", result}
-  };
-  
-  return test_a_program(parser, t);
+  } catch (const std::exception &e) {
+    std::cout << "exception: " << e.what() << std::endl;
+    std::cout << "when testing program_file: " << filename << std::endl;
+    return false;
+  }
 }
 
 static bool test_a_json(letter::Parser &parser, const json::value& json_block);
@@ -92,7 +99,10 @@ static bool test_a_json(letter::Parser &parser, const json::value& json_block) {
   }
 }
 
-static void test_parser() {
+/**
+ * @brief: the cases of tests.json, `threads` > 1 cuts every source into parts parsed in parallel
+ */
+static void test_parser(unsigned threads = 1) {
   const char* filename = __ROOT__ "tests/tests.json";
   std::ifstream ifs(filename);
   if (!ifs.is_open())
@@ -118,6 +128,7 @@ static void test_parser() {
   int fail = 0;
 
   letter::Parser parser;
+  parser.setThreads(threads, 0);
   std::for_each(
       tests_list.begin(), tests_list.end(), [&](const json::value &item) {
         if (test_a_json(parser, item)) {
@@ -127,16 +138,153 @@ static void test_parser() {
         }
       });
 
-  std::cout << "test parser completed\n"
+  std::cout << "test parser (" << threads << " threads) completed\n"
+    << "> Result:\nsuccess: " << success << "\nfail: " << fail << std::endl;
+
+}
+
+/**
+ * @brief: the cases of tests.json again, all at once through `parseMany` on several workers
+ * results must come back in order, the same as the serial parse
+ */
+static void test_parse_many() {
+  const char* filename = __ROOT__ "tests/tests.json";
+  std::ifstream ifs(filename);
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+
+  auto&& parse_opt = json::parse(ss.str());
+  if (!parse_opt) {
+    std::cout << "parse error: " << filename << std::endl;
+    return;
+  }
+
+  std::vector<std::string> programs;
+  std::vector<std::string> paths;
+  std::vector<json::value> source_results, path_results;
+
+  std::function<void(const json::value&)> collect = [&](const json::value& item) {
+    if (item.find("program")) {
+      programs.emplace_back(item.at("program").as_string());
+      source_results.emplace_back(item.at("result"));
+    } else if (item.find("program_file")) {
+      paths.emplace_back(item.at("program_file").as_string());
+      path_results.emplace_back(item.at("result"));
+    } else if (item.find("sub_json")) {
+      std::ifstream sub(item.at("sub_json").as_string());
+      std::stringstream sub_ss;
+      sub_ss << sub.rdbuf();
+      if (auto&& sub_json = json::parse(sub_ss.str())) {
+        collect(sub_json.value());
+      }
+    }
+  };
+  for (auto&& item : parse_opt.value()["tests_list"].as_array()) {
+    collect(item);
+  }
+  // one source that fails, its error must stay with it
+  programs.emplace_back("x = ;");
+  source_results.emplace_back("Unexpected token: \";\", expected: IDENTIRIFER");
+  std::vector<std::string_view> sources(programs.begin(), programs.end());
+
+  int success = 0;
+  int fail = 0;
+
+  auto&& check = [&](const std::vector<letter::ParseResult>& results, const std::vector<json::value>& expected) {
+    for (std::size_t i = 0; i < results.size(); ++i) {
+      auto&& actual = results[i].ok() ? results[i].toJson() : json::value(results[i].error);
+      if (actual == expected[i]) {
+        ++ success;
+      } else {
+        ++ fail;
+        std::cout << ">> test failure: parseMany input " << i << ":\n" << actual.format(true) << std::endl;
+      }
+    }
+  };
+
+  check(letter::parseMany(sources, 4), source_results);
+  check(letter::parseMany(paths, 4), path_results);
+
+  // the trees released by a parser which parses in parallel, as a parseMany worker releases them,
+  // must outlive its next parses
+  {
+    letter::Parser parallel;
+    parallel.setThreads(4, 0);
+    std::vector<letter::ParseResult> results(programs.size() - 1);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+      results[i].program = parallel.parseAst(programs[i]);
+      parallel.release(results[i].arena, results[i].symbols);
+    }
+    check(results, source_results);
+  }
+
+  std::cout << "test parseMany completed\n"
     << "> Result:\nsuccess: " << success << "\nfail: " << fail << std::endl;
+}
+
+/**
+ * @brief: sources which fail part way, the parallel parse must report the error of the serial one
+ */
+static void test_parallel_errors() {
+  static const char* const s_sources[] = {
+    "a = 1; b = 2; c = ; d = 4;",
+    "a = 1; { b = 2; } } c = 3;",
+    "a = 1; b = 'open; c = 3; d = 4;",
+    "a = 1; b = 2 /* c = 3; d = 4;",
+    "a = 1; { b = 2; c = 3; d = 4;",
+  };
+
+  int success = 0;
+  int fail = 0;
+
+  letter::Parser serial, parallel;
+  parallel.setThreads(4, 0);
+  auto&& outcome = [](letter::Parser& parser, const char* source) -> std::string {
+    try {
+      return parser.parse(source).to_string();
+    } catch (const std::exception& e) {
+      return std::string("error: ") + e.what();
+    }
+  };
+  for (auto* source : s_sources) {
+    auto&& expected = outcome(serial, source);
+    auto&& actual = outcome(parallel, source);
+    if (actual == expected) {
+      ++ success;
+    } else {
+      ++ fail;
+      std::cout << ">> test failure: " << source << "\nexpected: " << expected << "\nactual: " << actual << std::endl;
+    }
+  }
 
+  std::cout << "test parallel errors completed\n"
+    << "> Result:\nsuccess: " << success << "\nfail: " << fail << std::endl;
 }
 
 int main(int argc, char** argv) {
+  // --stats: print the allocation and node counters of the instrumentation build
+  const bool stats = argc > 1 && std::string(argv[1]) == "--stats";
+  letter::instrument::reset();
   {
     letter::ElapsedTimer t("md_test_parser total time");
     test_parser();
   }
+  {
+    letter::ElapsedTimer t("md_test_parser_parallel total time");
+    test_parser(4);
+    test_parallel_errors();
+  }
+  {
+    letter::ElapsedTimer t("md_test_parse_many total time");
+    test_parse_many();
+  }
+
+  if (stats) {
+    if (!letter::instrument::kEnabled) {
+      std::cout << "stats: instrumentation is off, configure with -DLETTER_INSTRUMENT=ON" << std::endl;
+    }
+    std::cout << "stats:\n" << letter::instrument::snapshot().toJson().format(true) << std::endl;
+  }
   return 0;
 }
 
@@ -0,0 +1,126 @@
+#include "json.hpp"
+
+#include "ElapsedTimer.h"
+#include "Exception.h"
+#include "Parser.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+/**
+ * @brief: the json ast of `source`, or the error message
+ */
+static std::string full_parse(const std::string &source) {
+  letter::Parser parser;
+  try {
+    return parser.parse(source).to_string();
+  } catch (const std::exception &e) {
+    return e.what();
+  }
+}
+
+/**
+ * @brief: apply every edit of `test` to its program, each reparse must match a full parse
+ * of the edited text, syntax errors included
+ */
+static bool test_a_program(const json::value &test) {
+  std::string source = test.at("program").as_string();
+
+  letter::Parser parser;
+  parser.setIncremental(true);
+
+  try {
+    parser.parse(source);
+
+    for (auto&& item : test.at("edits").as_array()) {
+      letter::TextEdit edit{static_cast<std::size_t>(item.at("offset").as_integer()),
+        static_cast<std::size_t>(item.at("removed").as_integer()), item.at("inserted").as_string()};
+
+      std::string actual;
+      try {
+        actual = parser.reparse(edit).to_string();
+      } catch (const letter::Exception &e) {
+        if (std::string(parser.source()) == source) {
+          throw; // the edit was rejected
+        }
+        actual = e.what();
+      }
+
+      source.replace(edit.offset, edit.removed, edit.inserted);
+      auto&& expected = full_parse(source);
+      if (actual != expected) {
+        std::cout << ">> test failure: " << std::endl;
+        std::cout << "edited program: \n\"" << source << "\"" << std::endl;
+        std::cout << "expected: \n" << expected << std::endl;
+        std::cout << "actual: \n" << actual << std::endl;
+        return false;
+      }
+    }
+
+    if (test.find("error")) {
+      std::cout << ">> test failure: expected error: " << test.at("error").as_string() << std::endl;
+      return false;
+    }
+
+    auto&& stats = parser.reparseStats();
+    if (stats.full || stats.reused_statements != static_cast<std::size_t>(test.at("reused_statements").as_integer())) {
+      std::cout << ">> test failure: \"" << source << "\" reused " << stats.reused_statements 
+                << " statements, " << stats.reused_nodes << " of " << stats.nodes << " nodes" << std::endl;
+      return false;
+    }
+    return true;
+
+  } catch (const std::exception &e) {
+    if (auto&& error = test.find("error"); error && error->as_string() == e.what()) {
+      return true;
+    }
+    std::cout << "exception: " << e.what() << std::endl;
+    std::cout << "when testing:\n" << test.format() << std::endl;
+    return false;
+  }
+}
+
+static void test_reparse() {
+  const char* filename = __ROOT__ "tests/reparse_tests.json";
+  std::ifstream ifs(filename);
+  if (!ifs.is_open()) {
+    std::cout << filename << " open failed" << std::endl;
+  }
+
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+
+  auto&& parse_opt = json::parse(ss.str());
+  if (!parse_opt) {
+    std::cout << "parse error: " << filename << std::endl;
+    return;
+  }
+
+  auto&& tests = parse_opt.value();
+  auto&& tests_list = tests["tests_list"].as_array();
+
+  int success = 0;
+  int fail = 0;
+
+  std::for_each(
+      tests_list.begin(), tests_list.end(), [&](const json::value &item) {
+        if (test_a_program(item)) {
+          ++ success;
+        } else {
+          ++ fail;
+        }
+      });
+
+  std::cout << "test reparse completed\n"
+    << "> Result:\nsuccess: " << success << "\nfail: " << fail << std::endl;
+}
+
+int main(int argc, char** argv) {
+  {
+    letter::ElapsedTimer t("md_test_reparse total time");
+    test_reparse();
+  }
+  return 0;
+}
@@ -1,10 +1,28 @@
 #include <iostream>
 #include "Parser.h"
 #include "ElapsedTimer.h"
+#include "Instrument.h"
+#include "Profiler.h"
 #include <string>
 
 
 int main(int argc, char **argv) {
+  // test_parser --stats ...: print the allocation and node counters of the instrumentation build
+  const bool stats = argc > 1 && std::string(argv[1]) == "--stats";
+  if (stats) {
+    --argc;
+    ++argv;
+    letter::instrument::reset();
+  }
+
+  // test_parser --trace out.json ...: write the zones of the profile build as a Chrome trace, and print their summary
+  std::string trace;
+  if (argc > 2 && std::string(argv[1]) == "--trace") {
+    trace = argv[2];
+    argc -= 2;
+    argv += 2;
+    letter::profile::reset();
+  }
   
   letter::Parser parser;
 
@@ -17,9 +35,25 @@ int main(int argc, char **argv) {
   
   letter::ElapsedTimer t("test_parser parse");
 
-  ret = parser.parse(program);
+  // test_parser <file>: parse a file instead, e.g. `echo "x = 1;" | test_parser /dev/stdin`
+  ret = argc > 1 ? parser.parseFile(argv[1]) : parser.parse(program);
     
   std::cout << ret.format() << std::endl;
+
+  if (stats) {
+    if (!letter::instrument::kEnabled) {
+      std::cout << "stats: instrumentation is off, configure with -DLETTER_INSTRUMENT=ON" << std::endl;
+    }
+    std::cout << "stats:\n" << letter::instrument::snapshot().toJson().format(true) << std::endl;
+  }
+
+  if (!trace.empty()) {
+    letter::profile::printSummary(std::cout);
+    if (!letter::profile::writeChromeTrace(trace)) {
+      std::cerr << "cannot write " << trace << std::endl;
+      return 1;
+    }
+  }
   
   return 0;
 }
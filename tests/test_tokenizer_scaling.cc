@@ -0,0 +1,116 @@
+#include "ElapsedTimer.h"
+#include "Tokenizer.h"
+#include "ProgramGenerator.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+/**
+ * @brief: tokenize the whole program
+ * @return: ns spent per input byte
+ */
+static double tokenize(const std::string& program, letter::Tokenizer::Engine engine) {
+  letter::Tokenizer tokenizer(program, engine);
+
+  std::size_t count = 0;
+  letter::ElapsedTimer<std::chrono::nanoseconds> t("tokenize", false);
+  while (!tokenizer.getNextToken().empty()) {
+    ++count;
+  }
+  auto ns = t.elapsed();
+
+  std::cout << "  " << program.size() << "(bytes), " << count << " tokens, "
+    << ns / 1000 << "(microseconds), " << static_cast<double>(ns) / program.size() << " ns/byte" << std::endl;
+  return static_cast<double>(ns) / program.size();
+}
+
+/**
+ * @brief: tokenize inputs from `min_size` up to `max_size` growing 10x each step
+ * @return: false if the per byte cost of the largest input is not close to linear
+ */
+static bool test_scaling(const char* name, letter::Tokenizer::Engine engine, 
+    std::size_t min_size, std::size_t max_size) {
+  std::cout << name << ":" << std::endl;
+
+  double baseline = 0;
+  double largest = 0;
+  for (std::size_t size = min_size; size <= max_size; size *= 10) {
+    largest = tokenize(letter::generate_program(size), engine);
+    // small inputs are dominated by noise, measure the baseline from 100KB on
+    if (size == 100 * 1024 || (baseline == 0 && size > 100 * 1024)) {
+      baseline = largest;
+    }
+  }
+
+  // quadratic behaviour makes ns/byte grow with the size, linear keeps it flat
+  if (baseline > 0 && largest > baseline * 4) {
+    std::cout << ">> " << name << " does not scale linearly: " 
+      << baseline << " ns/byte -> " << largest << " ns/byte" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief: a long run of comments must be skipped without recursion
+ */
+static bool test_comment_run(letter::Tokenizer::Engine engine) {
+  std::string program;
+  for (int i = 0; i < 200000; ++i) {
+    program += "// comment\n/* doc */\n";
+  }
+  program += "x;";
+
+  letter::Tokenizer tokenizer(program, engine);
+  auto&& token = tokenizer.getNextToken();
+  return token.kind == letter::TokenKind::Identifier && token.value == "x";
+}
+
+/**
+ * @brief: numbers are converted as they are tokenized, a fraction or an exponent without digits
+ * is not part of the number
+ */
+static bool test_numbers(letter::Tokenizer::Engine engine) {
+  using Kind = letter::NumberValue::Kind;
+  letter::Tokenizer tokenizer("7 0x1f 0XFF 2.5 1e3 6.25E-2 9223372036854775807 9223372036854775808 1e999 0x 3ex 2e+", 
+      engine);
+
+  static const std::pair<Kind, double> s_expected[] = {
+    {Kind::Integer, 7}, {Kind::Integer, 31}, {Kind::Integer, 255}, {Kind::Real, 2.5}, {Kind::Real, 1000},
+    {Kind::Real, 0.0625}, {Kind::Integer, 9223372036854775807.0}, {Kind::OutOfRange, 0}, {Kind::OutOfRange, 0},
+    {Kind::Integer, 0}, {Kind::Integer, 3}, {Kind::Integer, 2},
+  };
+  for (auto&& [kind, value] : s_expected) {
+    auto&& token = tokenizer.getNextToken();
+    if (token.kind != letter::TokenKind::Number || token.number.kind != kind || 
+        (kind != Kind::OutOfRange && token.number.toDouble() != value)) {
+      std::cout << ">> number \"" << token.value << "\" is not converted as expected" << std::endl;
+      return false;
+    }
+    // what follows a number which stops early
+    if (token.value == "0" || token.value == "3") {
+      tokenizer.getNextToken();
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  // 1KB to 100MB for the scanner, the regex engine is far slower, stop it at 1MB by default
+  std::size_t max_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100 * 1024 * 1024;
+  std::size_t max_regex_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1024 * 1024;
+
+  bool ok = true;
+  ok &= test_scaling("scanner", letter::Tokenizer::Engine::Scanner, 1024, max_size);
+  ok &= test_scaling("regex", letter::Tokenizer::Engine::Regex, 1024, max_regex_size);
+
+  ok &= test_comment_run(letter::Tokenizer::Engine::Scanner);
+  ok &= test_comment_run(letter::Tokenizer::Engine::Regex);
+
+  ok &= test_numbers(letter::Tokenizer::Engine::Scanner);
+  ok &= test_numbers(letter::Tokenizer::Engine::Regex);
+
+  std::cout << "test tokenizer scaling completed\n> Result: " << (ok ? "success" : "fail") << std::endl;
+  return ok ? 0 : 1;
+}